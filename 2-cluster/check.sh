@@ -0,0 +1,74 @@
+#!/usr/bin/env bash
+
+if [ "$#" -lt 1 ]; then
+    echo "Incorrect number of arguments"
+    echo "Usage: $0 <cmake_build_type> [number_of_threads]"
+    exit 1
+fi
+
+BUILD_TYPE=$(echo "$1" | tr '[:upper:]' '[:lower:]')
+THREADS=${2:-4}
+
+ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")" >/dev/null 2>&1 && pwd)/.."
+BIN_PATH="$ROOT/cmake-build-$BUILD_TYPE/2-cluster/src/2-cluster"
+
+# Datasets and results are looked up relative to the working directory, so
+# runs write to a scratch directory and `results` stays untouched.
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+ln -s "$ROOT/2-cluster/data" "$WORK/data"
+cd "$WORK" || exit 1
+
+FAILED=0
+
+# Runs every test with the given options into `out/<name>`.
+run() {
+    local name=$1
+    shift
+    mkdir -p results "out/$name"
+    local status=0
+    if ! "$BIN_PATH" "$@" > /dev/null 2> "out/$name.log"; then
+        echo "FAIL $name: $(tail -n 1 "out/$name.log")"
+        FAILED=1
+        status=1
+    fi
+    mv results/* "out/$name/" 2> /dev/null
+    return "$status"
+}
+
+# Results of two runs must be byte-identical.
+same() {
+    local what=$1 expected=$2 actual=$3
+    for test in 1 2 3 4 5; do
+        if ! cmp -s "out/$expected/$test" "out/$actual/$test"; then
+            echo "FAIL $what: test $test differs ($expected vs $actual)"
+            FAILED=1
+            return
+        fi
+    done
+    echo "ok   $what"
+}
+
+# Fixed-order sums don't depend on threads or schedule.
+run lloyd-1 --deterministic --threads=1
+run lloyd-n --deterministic --threads="$THREADS" --schedule=dynamic:64
+same "deterministic, 1 and $THREADS threads" lloyd-1 lloyd-n
+
+# Bounded engines and the k-d tree skip distances, never change labels; with
+# deterministic sums their centroids are identical too.
+for engine in elkan hamerly yinyang kdtree; do
+    run "$engine" --engine="$engine" --deterministic --threads="$THREADS"
+    same "$engine labels as lloyd" lloyd-1 "$engine"
+done
+
+# Resuming from a checkpoint ends where an uninterrupted run does.
+run partial --deterministic --threads="$THREADS" --max-iterations=12 \
+    --checkpoint=checkpoints
+run resumed --deterministic --threads="$THREADS" --warm-start=checkpoints
+same "resume from checkpoint" lloyd-1 resumed
+
+# The grid index must give the labels of a plain scan, `--predict` fails
+# otherwise.
+run predict --predict --threads="$THREADS" && echo "ok   indexed predictions"
+
+exit "$FAILED"
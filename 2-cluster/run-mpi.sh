@@ -0,0 +1,18 @@
+#!/usr/bin/env bash
+
+if [ "$#" -lt 2 ]; then
+    echo "Incorrect number of arguments"
+    echo "Usage: $0 <cmake_build_type> <number_of_processes> [options...]"
+    exit 1
+fi
+
+BUILD_TYPE=$(echo "$1" | tr '[:upper:]' '[:lower:]')
+PROCESSES=$2
+shift 2
+
+ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")" >/dev/null 2>&1 && pwd)/.."
+BIN_PATH="$ROOT/cmake-build-$BUILD_TYPE/2-cluster/src/2-cluster"
+
+# Datasets and results are looked up relative to the working directory.
+cd "$ROOT/2-cluster" || exit 1
+TMPDIR=/tmp mpirun --oversubscribe -np "$PROCESSES" "$BIN_PATH" --mpi "$@"
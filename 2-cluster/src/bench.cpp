@@ -0,0 +1,207 @@
+#include <omp.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+#include "bench.hpp"
+#include "io.hpp"
+#include "kernels.hpp"
+#include "numa.hpp"
+#include "random.hpp"
+#include "solver.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// Points sharing one random generator.
+constexpr auto kBlobBlock = config::Size{1} << 14;
+// Blocks generated in parallel before being written out.
+constexpr auto kBlobChunk = config::Size{64};
+
+constexpr auto kCenterRange = 100.0;
+
+auto BlobsPath(const std::string& directory, const Blobs& blobs)
+    -> std::string {
+  return directory + "/blobs-" + std::to_string(blobs.points) + '-' +
+         std::to_string(blobs.clusters) + '-' +
+         std::to_string(blobs.dimension) + '-' + std::to_string(blobs.seed) +
+         ".bin";
+}
+
+auto Seconds(config::Mcs duration) -> double {
+  return static_cast<double>(duration.count()) * 1e-6;
+}
+
+auto WriteRun(std::ostream& out, const Blobs& blobs, int threads,
+              const config::Schedule& schedule, Backend backend,
+              const Params& params, const Report& report, config::Mcs total)
+    -> void {
+  auto iterations = report.history.size();
+  auto iterating = Seconds(report.assign + report.update);
+  auto throughput =
+      iterating > 0 ? static_cast<double>(blobs.points * iterations) / iterating
+                    : 0.0;
+
+  out << "    {\"points\": " << blobs.points
+      << ", \"clusters\": " << blobs.clusters
+      << ", \"dimension\": " << blobs.dimension
+      << ", \"engine\": \"" << ToString(params.mode)
+      << "\", \"order\": \"" << ToString(params.order)
+      << "\", \"precision\": \"" << ToString(params.precision)
+      << "\", \"deterministic\": "
+      << (params.deterministic ? "true" : "false")
+      << ", \"threads\": " << threads
+      << ", \"schedule\": \"" << ToString(schedule)
+      << "\", \"backend\": \"" << ToString(backend)
+      << "\", \"iterations\": " << iterations
+      << ", \"read_us\": " << report.read.count()
+      << ", \"seed_us\": " << report.seeding.count()
+      << ", \"coreset_us\": " << report.coreset.count()
+      << ", \"reorder_us\": " << report.reorder.count()
+      << ", \"assign_us\": " << report.assign.count()
+      << ", \"update_us\": " << report.update.count()
+      << ", \"write_us\": " << report.write.count()
+      << ", \"total_us\": " << total.count() << std::fixed
+      << std::setprecision(0) << ", \"points_per_second\": " << throughput
+      << std::defaultfloat << std::setprecision(10)
+      << ", \"inertia\": " << report.inertia << ", \"placement\": [";
+
+  auto separator = "";
+  for (auto pages : report.placement) {
+    out << separator << pages;
+    separator = ", ";
+  }
+  out << "]}";
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto GenerateBlobs(const std::string& output, const Blobs& blobs) -> void {
+  if (blobs.clusters == 0 || blobs.points < blobs.clusters) {
+    throw std::invalid_argument("Fewer points than clusters");
+  }
+
+  const auto dim = blobs.dimension;
+
+  auto centers = std::vector<double>(blobs.clusters * dim);
+  auto random = Random{blobs.seed, 0, 0};
+  for (auto& coord : centers) {
+    coord = kCenterRange * (2 * random.Uniform() - 1);
+  }
+
+  auto header = BinaryHeader{};
+  header.point_count = blobs.points;
+  header.cluster_count = blobs.clusters;
+  header.dimension = dim;
+
+  auto out = std::ofstream{output, std::ios::binary};
+  if (!out) {
+    throw std::runtime_error("Cannot open " + output);
+  }
+  // NOLINTNEXTLINE
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  auto blocks = (blobs.points + kBlobBlock - 1) / kBlobBlock;
+  auto coords = std::vector<double>(kBlobChunk * kBlobBlock * dim);
+
+  for (auto first = config::Index{0}; first < blocks; first += kBlobChunk) {
+    auto last = std::min(first + kBlobChunk, blocks);
+
+    // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+    for (auto b = first; b < last; ++b) {
+      auto block = Random{blobs.seed, 1, b};
+      auto size = std::min(kBlobBlock, blobs.points - b * kBlobBlock);
+      auto* row = &coords[(b - first) * kBlobBlock * dim];
+
+      for (auto p = config::Index{0}; p < size; ++p, row += dim) {
+        const auto* center = &centers[block.Below(blobs.clusters) * dim];
+        for (auto d = config::Index{0}; d < dim; ++d) {
+          row[d] = center[d] + blobs.spread * block.Normal();
+        }
+      }
+    }
+
+    auto size = std::min(last * kBlobBlock, blobs.points) - first * kBlobBlock;
+    // NOLINTNEXTLINE
+    out.write(reinterpret_cast<const char*>(coords.data()),
+              static_cast<std::streamsize>(size * dim * sizeof(double)));
+  }
+
+  if (!out) {
+    throw std::runtime_error("Cannot write " + output);
+  }
+}
+
+auto RunBenchmark(const Benchmark& benchmark, std::ostream& out) -> void {
+  auto directory = benchmark.directory.empty()
+                       ? (std::filesystem::temp_directory_path() /
+                          "2-cluster-bench")
+                             .string()
+                       : benchmark.directory;
+  std::filesystem::create_directories(directory);
+  auto result = directory + "/result";
+
+  out << "{\n  \"isa\": \"" << kernels::Isa()
+      << "\",\n  \"processors\": " << omp_get_num_procs()
+      << ",\n  \"domains\": " << numa::Domains()
+      << ",\n  \"pinned\": " << (benchmark.pin ? "true" : "false")
+      << ",\n  \"runs\": [\n";
+
+  auto separator = "";
+  for (auto size : benchmark.sizes) {
+    for (auto clusters : benchmark.cluster_counts) {
+      auto blobs = Blobs{size, clusters, benchmark.dimension};
+      blobs.seed = benchmark.params.seed;
+
+      auto input = BlobsPath(directory, blobs);
+      if (!std::filesystem::exists(input)) {
+        GenerateBlobs(input, blobs);
+      }
+
+      for (auto threads : benchmark.threads) {
+        for (auto backend : benchmark.backends) {
+          auto schedules = backend == Backend::kOpenMp
+                               ? benchmark.schedules.size()
+                               : std::min<config::Size>(
+                                     benchmark.schedules.size(), 1);
+
+          for (auto s = config::Index{0}; s < schedules; ++s) {
+            const auto& schedule = benchmark.schedules[s];
+            config::SetThreadCount(threads);
+            config::SetSchedule(schedule);
+            parallel::SetBackend(backend);
+            if (benchmark.pin) {
+              numa::PinThreads();
+            }
+
+            // Same initial centroids for every setting.
+            std::srand(static_cast<unsigned>(benchmark.params.seed));
+
+            auto solver = Solver{benchmark.params};
+            auto start = config::Clock::now();
+            solver.Solve(input, result);
+            auto total = config::Since(start);
+
+            out << separator;
+            WriteRun(out, blobs, threads, schedule, backend,
+                     benchmark.params, solver.LastReport(), total);
+            out << std::flush;
+            separator = ",\n";
+          }
+        }
+      }
+    }
+  }
+
+  out << "\n  ]\n}\n";
+
+  std::filesystem::remove(result);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+#include "parallel.hpp"
+#include "params.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Synthetic dataset of `points` points around `clusters` centers drawn
+// uniformly from `[-100, 100]^dimension`, every point is a center plus
+// Gaussian noise of deviation `spread`.
+struct Blobs {
+  config::Size points{0};
+  config::Size clusters{0};
+  config::Size dimension{2};
+  double spread{1};
+  std::uint64_t seed{1};
+};
+
+// Writes `blobs` as a binary dataset. Points are generated in parallel
+// a chunk at a time and streamed to the file, so even 1e8 points take a few
+// megabytes of memory; contents depend on `blobs` only, not on threads.
+auto GenerateBlobs(const std::string& output, const Blobs& blobs) -> void;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Sweep over datasets and parallel settings, every combination is solved
+// once with `params`.
+struct Benchmark {
+  std::vector<config::Size> sizes{100'000, 1'000'000};
+  std::vector<config::Size> cluster_counts{10, 100};
+  config::Size dimension{2};
+
+  std::vector<int> threads{1, 2, 4};
+  std::vector<config::Schedule> schedules{
+      {config::Schedule::Kind::kStatic, 0},
+      {config::Schedule::Kind::kDynamic, 64},
+      {config::Schedule::Kind::kGuided, 0},
+  };
+  // Schedules apply to `Backend::kOpenMp` only, other backends run with
+  // the first one.
+  std::vector<Backend> backends{Backend::kOpenMp};
+
+  Params params{};
+  bool pin{false};  // `numa::PinThreads` for every thread count
+
+  // Generated datasets are kept here and reused by later sweeps.
+  std::string directory;
+};
+
+// Runs the sweep and writes a JSON object to `out`: the machine, then one
+// entry per run with its settings, iterations, time of every phase
+// (read, seed, assign, update, write), assigned points per second and
+// pages of points resident on every NUMA node.
+auto RunBenchmark(const Benchmark& benchmark, std::ostream& out) -> void;
@@ -0,0 +1,315 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+#include "bisecting.hpp"
+#include "io.hpp"
+#include "random.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// Lloyd iterations of every split, fewer if its means stop moving.
+constexpr auto kSplitIterations = 10;
+
+// Splits of fewer points run as a single task, larger ones spread passes
+// over points across tasks of that many points.
+constexpr auto kTaskPoints = config::Size{1} << 14;
+
+// Sums of points nearer to one of the two means.
+struct Halves {
+  std::array<double, 2> x{};
+  std::array<double, 2> y{};
+  std::array<config::Size, 2> size{};
+  std::array<double, 2> squares{};  // sums of squared norms
+};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto ClusterTree::Predict(const Point& p) const -> config::Index {
+  auto node = config::Index{0};
+  while (nodes[node].left != 0) {
+    const auto& left = nodes[nodes[node].left];
+    const auto& right = nodes[nodes[node].right];
+    auto lx = p.x - left.x;
+    auto ly = p.y - left.y;
+    auto rx = p.x - right.x;
+    auto ry = p.y - right.y;
+    node = lx * lx + ly * ly <= rx * rx + ry * ry ? nodes[node].left
+                                                  : nodes[node].right;
+  }
+  return nodes[node].cluster;
+}
+
+auto ClusterTree::Predict(Points& points) const -> void {
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(runtime)
+  for (auto p = config::Index{0}; p < points.size(); ++p) {
+    points[p].cluster_index = Predict(points[p]);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BisectingSolver::BisectingSolver(Params params) : params_(params) {
+}
+
+auto BisectingSolver::Solve(const std::string& input,
+                            const std::string& output) -> void {
+  report_ = {};
+
+  auto start = config::Clock::now();
+  Read(input);
+  report_.read = config::Since(start);
+
+  const auto k = clusters_.size();
+  if (points_.size() < k) {
+    throw std::invalid_argument("Fewer points than clusters");
+  }
+
+  start = config::Clock::now();
+  tree_.nodes.assign(2 * k - 1, {});
+
+#pragma omp parallel num_threads(config::ThreadCount())
+#pragma omp single
+  Split(0, 0, entries_.size(), k, 0);
+
+  report_.assign = config::Since(start);
+
+  report_.inertia = ComputeInertia();
+
+  start = config::Clock::now();
+  WriteResult(output, clusters_, points_);
+  report_.write = config::Since(start);
+}
+
+auto BisectingSolver::LastReport() const -> const Report& {
+  return report_;
+}
+
+auto BisectingSolver::LastTree() const -> const ClusterTree& {
+  return tree_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto BisectingSolver::Read(const std::string& input) -> void {
+  clusters_.assign(ReadDataset(input, points_), Cluster{});
+
+  entries_.resize(points_.size());
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto p = config::Index{0}; p < points_.size(); ++p) {
+    entries_[p] = {points_[p].x, points_[p].y, p};
+  }
+}
+
+auto BisectingSolver::Split(config::Index node, config::Index first,
+                            config::Index last, config::Size budget,
+                            config::Index label) -> void {
+  const auto size = last - first;
+
+  auto sum_x = 0.0;
+  auto sum_y = 0.0;
+  for (auto i = first; i < last; ++i) {
+    sum_x += entries_[i].x;
+    sum_y += entries_[i].y;
+  }
+
+  auto& self = tree_.nodes[node];
+  self.x = sum_x / static_cast<double>(size);
+  self.y = sum_y / static_cast<double>(size);
+
+  if (budget == 1) {
+    self.cluster = label;
+    clusters_[label].Centroid().x = self.x;
+    clusters_[label].Centroid().y = self.y;
+    for (auto i = first; i < last; ++i) {
+      points_[entries_[i].index].cluster_index = label;
+    }
+    return;
+  }
+
+  auto costs = std::array<double, 2>{};
+  auto middle = Bisect(node, first, last, costs);
+
+  // In the plane, a cluster of cost `C` split into `b` leaves costs about
+  // `C / b`, so the sum is the lowest for shares proportional to `sqrt(C)`.
+  // At least one leaf per half though, and no more leaves than points.
+  const auto n1 = middle - first;
+  const auto n2 = last - middle;
+  auto root0 = std::sqrt(costs[0]);
+  auto root1 = std::sqrt(costs[1]);
+  auto fraction = root0 + root1 > 0 ? root0 / (root0 + root1)
+                                    : static_cast<double>(n1) /
+                                          static_cast<double>(size);
+  auto share = static_cast<config::Size>(
+      std::llround(static_cast<double>(budget) * fraction));
+  auto least = n2 < budget ? budget - n2 : config::Size{1};
+  share = std::clamp(share, least, std::min(n1, budget - 1));
+
+  self.left = node + 1;
+  self.right = node + 2 * share;
+
+#pragma omp task default(shared) if (n1 > kTaskPoints)
+  Split(self.left, first, middle, share, label);
+
+  Split(self.right, middle, last, budget - share, label + share);
+
+#pragma omp taskwait
+}
+
+auto BisectingSolver::Bisect(config::Index node, config::Index first,
+                             config::Index last, std::array<double, 2>& costs)
+    -> config::Index {
+  const auto size = last - first;
+  const auto tasks = (size + kTaskPoints - 1) / kTaskPoints;
+
+  // Calls `pass(a, b)` on consecutive ranges of at most `kTaskPoints`
+  // entries, as tasks if there are several.
+  auto parts = std::vector<Halves>(tasks);
+  auto for_parts = [&](auto pass) {
+#pragma omp taskloop default(shared) if (tasks > 1)
+    for (auto t = config::Index{0}; t < tasks; ++t) {
+      auto a = first + t * kTaskPoints;
+      parts[t] = pass(a, std::min(last, a + kTaskPoints));
+    }
+  };
+
+  // k-means++ with two means: a uniform point, then one sampled with
+  // probability proportional to its squared distance to the first.
+  auto random = Random{params_.seed, 0, node};
+  const auto& seed = entries_[first + random.Below(size)];
+  auto mx = std::array<double, 2>{seed.x, seed.x};
+  auto my = std::array<double, 2>{seed.y, seed.y};
+
+  for_parts([&](config::Index a, config::Index b) {
+    auto part = Halves{};
+    for (auto i = a; i < b; ++i) {
+      auto dx = entries_[i].x - mx[0];
+      auto dy = entries_[i].y - my[0];
+      part.x[0] += dx * dx + dy * dy;
+    }
+    return part;
+  });
+
+  auto total = 0.0;
+  for (const auto& part : parts) {
+    total += part.x[0];
+  }
+
+  auto target = random.Uniform() * total;
+  for (auto i = first; i < last; ++i) {
+    auto dx = entries_[i].x - mx[0];
+    auto dy = entries_[i].y - my[0];
+    auto d = dx * dx + dy * dy;
+    if (d > 0 && target < d) {
+      mx[1] = entries_[i].x;
+      my[1] = entries_[i].y;
+      break;
+    }
+    target -= d;
+  }
+
+  auto nearer_first = [&](const Entry& e) {
+    auto d0 = (e.x - mx[0]) * (e.x - mx[0]) + (e.y - my[0]) * (e.y - my[0]);
+    auto d1 = (e.x - mx[1]) * (e.x - mx[1]) + (e.y - my[1]) * (e.y - my[1]);
+    return d0 <= d1;
+  };
+
+  for (auto it = 0; it < kSplitIterations; ++it) {
+    for_parts([&](config::Index a, config::Index b) {
+      auto part = Halves{};
+      for (auto i = a; i < b; ++i) {
+        auto h = nearer_first(entries_[i]) ? config::Index{0} : 1;
+        part.x[h] += entries_[i].x;
+        part.y[h] += entries_[i].y;
+        ++part.size[h];
+      }
+      return part;
+    });
+
+    auto sums = Halves{};
+    for (const auto& part : parts) {
+      for (auto h = config::Index{0}; h < 2; ++h) {
+        sums.x[h] += part.x[h];
+        sums.y[h] += part.y[h];
+        sums.size[h] += part.size[h];
+      }
+    }
+    if (sums.size[0] == 0 || sums.size[1] == 0) {
+      break;
+    }
+
+    auto moved = false;
+    for (auto h = config::Index{0}; h < 2; ++h) {
+      auto x = sums.x[h] / static_cast<double>(sums.size[h]);
+      auto y = sums.y[h] / static_cast<double>(sums.size[h]);
+      moved = moved || x != mx[h] || y != my[h];
+      mx[h] = x;
+      my[h] = y;
+    }
+    if (!moved) {
+      break;
+    }
+  }
+
+  auto* begin = &entries_[0];
+  auto middle = static_cast<config::Index>(
+      std::partition(begin + first, begin + last, nearer_first) - begin);
+
+  // All points coincide: halves by position.
+  if (middle == first || middle == last) {
+    middle = first + size / 2;
+  }
+
+  for_parts([&](config::Index a, config::Index b) {
+    auto part = Halves{};
+    for (auto i = a; i < b; ++i) {
+      auto h = i < middle ? config::Index{0} : 1;
+      part.x[h] += entries_[i].x;
+      part.y[h] += entries_[i].y;
+      part.squares[h] +=
+          entries_[i].x * entries_[i].x + entries_[i].y * entries_[i].y;
+      ++part.size[h];
+    }
+    return part;
+  });
+
+  auto sums = Halves{};
+  for (const auto& part : parts) {
+    for (auto h = config::Index{0}; h < 2; ++h) {
+      sums.x[h] += part.x[h];
+      sums.y[h] += part.y[h];
+      sums.squares[h] += part.squares[h];
+      sums.size[h] += part.size[h];
+    }
+  }
+
+  for (auto h = config::Index{0}; h < 2; ++h) {
+    auto n = static_cast<double>(sums.size[h]);
+    auto mean2 = (sums.x[h] * sums.x[h] + sums.y[h] * sums.y[h]) / n;
+    costs[h] = std::max(0.0, sums.squares[h] - mean2);
+  }
+
+  return middle;
+}
+
+auto BisectingSolver::ComputeInertia() const -> double {
+  auto inertia = 0.0;
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static) reduction(+:inertia)
+  for (auto p = config::Index{0}; p < points_.size(); ++p) {
+    const auto& centroid = clusters_[points_[p].cluster_index].Centroid();
+    auto dx = points_[p].x - centroid.x;
+    auto dy = points_[p].y - centroid.y;
+    inertia += dx * dx + dy * dy;
+  }
+
+  return inertia;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+#include "cluster.hpp"
+#include "params.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Binary tree of clusters built by `BisectingSolver`, leaves being the
+// final clusters. Labels new points in `O(log k)` by descending towards
+// the nearer child mean, which usually but not always is the leaf with the
+// nearest centroid.
+class ClusterTree {
+ public:
+  struct Node {
+    double x{0};  // mean of the points of the node
+    double y{0};
+
+    // Children, zero for leaves (the root is nobody's child).
+    config::Index left{0};
+    config::Index right{0};
+
+    config::Index cluster{0};  // label of a leaf
+  };
+
+  auto Predict(const Point& p) const -> config::Index;
+
+  // Sets `cluster_index` of every point, in parallel.
+  auto Predict(Points& points) const -> void;
+
+ public:
+  std::vector<Node> nodes;  // `nodes[0]` is the root
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Bisecting k-means for large `k`: the dataset is split by 2-means
+// (k-means++ seeded, a few Lloyd iterations), then both halves recursively,
+// until there is a leaf per cluster. Every node is given a budget of leaves,
+// shared between its halves in proportion to the square roots of their
+// costs (to their sizes if both costs are zero), so that subtrees are
+// independent: they run as OpenMP tasks, and large splits spread their
+// passes over points across threads as well. Costs `O(n log k)` per pass
+// instead of `O(n k)` for Lloyd.
+//
+// Labels are the leaves points end up in and centroids the leaf means. The
+// tree is kept for labelling new points. Nodes of a subtree with a budget of
+// `b` leaves take `2b - 1` consecutive indices and its leaves `b`
+// consecutive labels, so the result is reproducible from `Params::seed` and
+// does not depend on the thread count.
+class BisectingSolver {
+ public:
+  explicit BisectingSolver(Params params);
+
+  auto Solve(const std::string& input, const std::string& output) -> void;
+
+  // `assign` covers all of the clustering, `history` stays empty.
+  auto LastReport() const -> const Report&;
+
+  auto LastTree() const -> const ClusterTree&;
+
+ private:
+  // Point in the order of the tree, `index` into `points_`.
+  struct Entry {
+    double x{0};
+    double y{0};
+    config::Index index{0};
+  };
+
+  auto Read(const std::string& input) -> void;
+
+  // Builds subtree `node` out of `entries_[first, last)` with `budget`
+  // leaves labelled from `label` on.
+  auto Split(config::Index node, config::Index first, config::Index last,
+             config::Size budget, config::Index label) -> void;
+
+  // Partitions `entries_[first, last)` by 2-means, returns where the second
+  // half starts. `costs` are set to the sums of squared distances of both
+  // halves to their means.
+  auto Bisect(config::Index node, config::Index first, config::Index last,
+              std::array<double, 2>& costs) -> config::Index;
+
+  auto ComputeInertia() const -> double;
+
+ private:
+  Params params_;
+  Report report_;
+
+  Points points_;
+  Clusters clusters_;
+  std::vector<Entry> entries_;
+  ClusterTree tree_;
+};
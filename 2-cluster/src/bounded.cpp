@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "bounded.hpp"
+#include "parallel.hpp"
+#include "trace.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr auto kInf = std::numeric_limits<double>::infinity();
+
+// Relative error tolerated in stored bounds.
+constexpr auto kSlack = 1e-12;
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+BoundedEngine::BoundedEngine(Points& points, Clusters& clusters)
+    : points_(points),
+      clusters_(clusters),
+      drift_(clusters.size(), 0),
+      total_drift_(clusters.size(), 0),
+      slack_(kSlack),
+      sums_(clusters) {
+}
+
+auto BoundedEngine::Assign() -> void {
+  Refresh();
+
+  sums_.Reset();
+
+  // Chunks of a block of points, whose costs vary with pruning.
+  stats_ = parallel::Reduce<StepStats>(
+      points_.size(), config::kBlockSize,
+      [this](config::Index first, config::Index last) {
+        TRACE_WORK();
+        auto stats = StepStats{};
+        for (auto p = first; p < last; ++p) {
+          auto previous = points_[p].cluster_index;
+          stats.computed += initialized_ ? AssignPruned(p) : AssignAll(p);
+
+          auto c = points_[p].cluster_index;
+          if (c != previous) {
+            ++stats.changed;
+          }
+          stats.inertia += Distance2To(c, points_[p]);
+          sums_.Local()[c].Add(points_[p]);
+        }
+        return stats;
+      });
+
+  sums_.Flush();
+
+  stats_.skipped = points_.size() * clusters_.size() - stats_.computed;
+  initialized_ = true;
+}
+
+auto BoundedEngine::Update() -> bool {
+  refreshed_ = false;
+  return UpdateClusters(clusters_);
+}
+
+auto BoundedEngine::Refresh() -> void {
+  if (refreshed_) {
+    return;
+  }
+
+  // `centroids_` still hold the centroids points were assigned to.
+  if (initialized_) {
+    ComputeDrift();
+  }
+
+  centroids_.Load(clusters_);
+
+  if (initialized_) {
+    Prepare();
+  }
+
+  refreshed_ = true;
+}
+
+auto BoundedEngine::LastStats() const -> StepStats {
+  return stats_;
+}
+
+auto BoundedEngine::Distance2To(config::Index c, const Point& p) const
+    -> double {
+  auto dx = p.x - centroids_.x[c];
+  auto dy = p.y - centroids_.y[c];
+  return dx * dx + dy * dy;
+}
+
+auto BoundedEngine::Inflate(double upper) const -> double {
+  return upper * (1 + kSlack) + slack_;
+}
+
+auto BoundedEngine::ComputeDrift() -> void {
+  auto max_drift = 0.0;
+
+  for (auto c = config::Index{0}; c < clusters_.size(); ++c) {
+    const auto& centroid = clusters_[c].Centroid();
+    auto dx = centroid.x - centroids_.x[c];
+    auto dy = centroid.y - centroids_.y[c];
+    drift_[c] = std::sqrt(dx * dx + dy * dy);
+    total_drift_[c] += drift_[c];
+    max_drift = std::max(max_drift, total_drift_[c]);
+  }
+
+  slack_ = kSlack * (1 + max_drift);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto ComputeSeparation(const Centroids& centroids, std::vector<double>& half)
+    -> void {
+  const auto k = centroids.Count();
+  half.resize(k);
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(runtime)
+  for (auto i = config::Index{0}; i < k; ++i) {
+    auto nearest = kInf;
+
+    for (auto j = config::Index{0}; j < k; ++j) {
+      auto dx = centroids.x[i] - centroids.x[j];
+      auto dy = centroids.y[i] - centroids.y[j];
+      if (auto dist = dx * dx + dy * dy; i != j && dist < nearest) {
+        nearest = dist;
+      }
+    }
+
+    half[i] = std::sqrt(nearest) / 2;
+  }
+}
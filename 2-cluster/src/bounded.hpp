@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+
+#include "engine.hpp"
+#include "kernels.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Common skeleton of engines that skip distance evaluations with
+// triangle inequality bounds. The first iteration assigns every point with
+// full information, later ones may prune using bounds kept by the subclass.
+// All subclasses produce exactly the assignments of `LloydEngine`.
+class BoundedEngine : public IEngine {
+ public:
+  BoundedEngine(Points& points, Clusters& clusters);
+
+  auto Assign() -> void final;
+  auto Update() -> bool final;
+  auto Refresh() -> void final;
+
+  auto LastStats() const -> StepStats final;
+
+ protected:
+  // Called once per iteration (but the first) before points are assigned,
+  // once centroids and drifts are refreshed.
+  virtual auto Prepare() -> void = 0;
+
+  // Both return the number of distances evaluated for point `p`.
+  virtual auto AssignAll(config::Index p) -> config::Size = 0;
+  virtual auto AssignPruned(config::Index p) -> config::Size = 0;
+
+  auto Distance2To(config::Index c, const Point& p) const -> double;
+
+  // Widens an upper bound by the worst rounding error of stored bounds.
+  // Pruning is only done when it holds with this margin, so rounding never
+  // prunes the nearest centroid, and a centroid at exactly the same
+  // distance is still evaluated for Lloyd's lowest-index tie breaking.
+  auto Inflate(double upper) const -> double;
+
+ private:
+  auto ComputeDrift() -> void;
+
+ protected:
+  Points& points_;
+  Clusters& clusters_;
+  Centroids centroids_;
+
+  std::vector<double> drift_;        // distance moved in the last update
+  std::vector<double> total_drift_;  // distance moved since the start
+
+ private:
+  double slack_{0};
+  DomainSums sums_;
+
+  bool initialized_{false};
+  bool refreshed_{false};
+  StepStats stats_{};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Half distance from every centroid to the nearest other one:
+// a point closer than that to its centroid can't be closer to any other.
+auto ComputeSeparation(const Centroids& centroids, std::vector<double>& half)
+    -> void;
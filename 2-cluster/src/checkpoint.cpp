@@ -0,0 +1,178 @@
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "checkpoint.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr auto kMagic = std::string_view{"checkpoint"};
+constexpr auto kMaxNumber = 32;
+
+auto Append(std::string& out, double value) -> void {
+  char buffer[kMaxNumber];
+  auto [ptr, ec] = std::to_chars(std::begin(buffer), std::end(buffer), value);
+  out.append(std::begin(buffer), ptr);
+}
+
+template <typename T>
+auto Parse(std::string_view& line, T& value) -> bool {
+  while (!line.empty() && (line.front() == ' ' || line.front() == '\t')) {
+    line.remove_prefix(1);
+  }
+  auto [ptr, ec] = std::from_chars(line.data(), line.data() + line.size(),
+                                   value);
+  line.remove_prefix(static_cast<std::size_t>(ptr - line.data()));
+  return ec == std::errc{};
+}
+
+// Whole `text`, synced before returning.
+auto WriteFile(const std::string& path, const std::string& text) -> void {
+  auto fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot open " + path);
+  }
+
+  auto left = std::string_view{text};
+  while (!left.empty()) {
+    auto written = ::write(fd, left.data(), left.size());
+    if (written < 0) {
+      ::close(fd);
+      throw std::runtime_error("Cannot write " + path);
+    }
+    left.remove_prefix(static_cast<std::size_t>(written));
+  }
+
+  if (::fsync(fd) != 0 || ::close(fd) != 0) {
+    throw std::runtime_error("Cannot write " + path);
+  }
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto WriteCheckpoint(const std::string& path, const Checkpoint& checkpoint)
+    -> void {
+  auto text = std::string{kMagic} + ' ' +
+              std::to_string(checkpoint.iteration) + ' ' +
+              std::to_string(checkpoint.seed) + '\n';
+  for (const auto& c : checkpoint.centroids) {
+    Append(text, c.x);
+    text += ' ';
+    Append(text, c.y);
+    text += '\n';
+  }
+
+  auto temporary = path + ".tmp";
+  WriteFile(temporary, text);
+  std::filesystem::rename(temporary, path);
+}
+
+auto ReadCheckpoint(const std::string& path, std::uint64_t seed)
+    -> Checkpoint {
+  auto in = std::ifstream{path};
+  if (!in) {
+    throw std::runtime_error("Cannot open " + path);
+  }
+
+  auto checkpoint = Checkpoint{};
+  checkpoint.seed = seed;
+
+  auto line = std::string{};
+  auto first = true;
+  while (std::getline(in, line)) {
+    auto rest = std::string_view{line};
+
+    if (first && rest.starts_with(kMagic)) {
+      rest.remove_prefix(kMagic.size());
+      if (!Parse(rest, checkpoint.iteration) ||
+          !Parse(rest, checkpoint.seed)) {
+        throw std::runtime_error("Bad checkpoint header in " + path);
+      }
+      first = false;
+      continue;
+    }
+    first = false;
+
+    // Labels following centroids in `results/` hold a single number.
+    auto centroid = Point{};
+    if (!Parse(rest, centroid.x) || !Parse(rest, centroid.y)) {
+      break;
+    }
+    checkpoint.centroids.push_back(centroid);
+  }
+
+  if (checkpoint.centroids.empty()) {
+    throw std::runtime_error("No centroids in " + path);
+  }
+  return checkpoint;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+CheckpointWriter::CheckpointWriter(std::string path)
+    : path_(std::move(path)), thread_([this] { Run(); }) {
+}
+
+CheckpointWriter::~CheckpointWriter() {
+  {
+    auto lock = std::lock_guard{mutex_};
+    stopping_ = true;
+  }
+  changed_.notify_all();
+  thread_.join();
+}
+
+auto CheckpointWriter::Save(Checkpoint checkpoint) -> void {
+  {
+    auto lock = std::lock_guard{mutex_};
+    waiting_ = std::move(checkpoint);
+  }
+  changed_.notify_all();
+}
+
+auto CheckpointWriter::Flush() -> void {
+  auto lock = std::unique_lock{mutex_};
+  changed_.wait(lock, [&] { return !waiting_ && !writing_; });
+  if (error_) {
+    std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+}
+
+auto CheckpointWriter::Run() -> void {
+  auto lock = std::unique_lock{mutex_};
+  while (true) {
+    changed_.wait(lock, [&] { return waiting_ || stopping_; });
+    if (!waiting_) {
+      return;
+    }
+
+    auto checkpoint = std::move(*waiting_);
+    waiting_.reset();
+    writing_ = true;
+
+    auto error = std::exception_ptr{};
+    lock.unlock();
+    try {
+      WriteCheckpoint(path_, checkpoint);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    lock.lock();
+
+    if (!error_) {
+      error_ = error;
+    }
+    writing_ = false;
+    changed_.notify_all();
+  }
+}
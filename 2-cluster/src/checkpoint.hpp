@@ -0,0 +1,71 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "config.hpp"
+#include "cluster.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// State to resume a run from. Iterating draws no random numbers and resumed
+// runs are not seeded, so `seed` is all the random state left: it rebuilds
+// the same coreset, see `BuildCoreset`.
+struct Checkpoint {
+  config::Size iteration{0};  // iterations completed
+  std::uint64_t seed{0};
+  Points centroids;
+};
+
+// Text file: `checkpoint <iteration> <seed>`, then a centroid per line with
+// shortest round-trip coordinates. Written to `<path>.tmp`, synced and
+// renamed over `path`, so a run killed midway leaves the previous
+// checkpoint intact.
+auto WriteCheckpoint(const std::string& path, const Checkpoint& checkpoint)
+    -> void;
+
+// Reads a checkpoint, or else centroids `x y` from the leading lines of any
+// text file, such as `results/<test>`: these resume at iteration zero with
+// `seed`.
+auto ReadCheckpoint(const std::string& path, std::uint64_t seed)
+    -> Checkpoint;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Writes checkpoints to `path` on a thread of its own, so iterating only
+// waits for centroids to be copied. A checkpoint saved while another is
+// being written replaces any still waiting: only the latest one matters.
+class CheckpointWriter {
+ public:
+  explicit CheckpointWriter(std::string path);
+  ~CheckpointWriter();  // writes the waiting checkpoint, if any
+
+  CheckpointWriter(const CheckpointWriter&) = delete;
+  auto operator=(const CheckpointWriter&) -> CheckpointWriter& = delete;
+
+  auto Save(Checkpoint checkpoint) -> void;
+
+  // Waits until all saved checkpoints are written,
+  // rethrows the first failure to write one.
+  auto Flush() -> void;
+
+ private:
+  auto Run() -> void;
+
+ private:
+  std::string path_;
+
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  std::optional<Checkpoint> waiting_;
+  bool writing_{false};
+  bool stopping_{false};
+  std::exception_ptr error_;
+
+  std::thread thread_;  // last, starts once everything above is set
+};
@@ -1,4 +1,6 @@
 #include <cmath>
+#include <utility>
+
 #include "cluster.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -42,20 +44,48 @@ auto Cluster::DistanceTo(const Point& p) const -> double {
 }
 
 auto Cluster::Add(const Point& p) -> void {
+  if (p.weight != 1) {
+    auto weighted = Point{};
+    weighted.x = p.weight * p.x;
+    weighted.y = p.weight * p.y;
+    Add(weighted, p.weight);
+    return;
+  }
+
   update_ += p;
 
 #pragma omp atomic
   size_ += 1;
 }
 
+auto Cluster::Add(const Point& sum, double weight) -> void {
+  update_ += sum;
+
+#pragma omp atomic
+  weight_ += weight;
+}
+
 auto Cluster::Update() -> bool {
-  update_.x /= static_cast<double>(size_);
-  update_.y /= static_cast<double>(size_);
+  auto weight = static_cast<double>(size_) + weight_;
+  update_.x /= weight;
+  update_.y /= weight;
 
   auto dist = centroid_.DistanceTo(update_);
 
   centroid_ = std::exchange(update_, {});
   size_ = 0;
+  weight_ = 0;
 
   return dist > 1e-6;
 }
+
+auto Cluster::Pending() const -> std::pair<Point, double> {
+  return {update_, static_cast<double>(size_) + weight_};
+}
+
+auto Cluster::SetPending(const Point& sum, double weight) -> void {
+  update_.x = sum.x;
+  update_.y = sum.y;
+  size_ = 0;
+  weight_ = weight;
+}
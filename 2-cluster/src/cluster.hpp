@@ -1,9 +1,11 @@
 #pragma once
 
 #include <iostream>
+#include <utility>
 #include <vector>
 
 #include "config.hpp"
+#include "numa.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -17,12 +19,14 @@ struct Point {
   alignas(config::hardware_destructive_interference_size) double x{0};
   alignas(config::hardware_destructive_interference_size) double y{0};
   config::Index cluster_index{0};
+  double weight{1};  // of a coreset point, see `BuildCoreset`
 };
 
 auto operator>>(std::istream& in, Point& p) -> std::istream&;
 auto operator<<(std::ostream& out, const Point& p) -> std::ostream&;
 
-using Points = std::vector<Point>;
+// Placed by first touch, see `numa::FirstTouchAllocator`.
+using Points = std::vector<Point, numa::FirstTouchAllocator<Point>>;
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -33,13 +37,22 @@ class Cluster {
 
   auto DistanceTo(const Point& p) const -> double;
 
+  // Counts `p` `p.weight` times, unit-weight points take an integer path.
   auto Add(const Point& p) -> void;
+  // Adds points of total weight `weight` at once, `sum` being their
+  // weighted sum.
+  auto Add(const Point& sum, double weight) -> void;
   auto Update() -> bool;
 
+  // Weighted sum and total weight of points added since the last `Update`.
+  auto Pending() const -> std::pair<Point, double>;
+  auto SetPending(const Point& sum, double weight) -> void;
+
  private:
   Point centroid_{};
   Point update_{};
   alignas(config::hardware_destructive_interference_size) config::Size size_{0};
+  double weight_{0};  // of points added with a weight other than 1
 };
 
 using Clusters = std::vector<Cluster>;
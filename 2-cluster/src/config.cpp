@@ -0,0 +1,93 @@
+#include <omp.h>
+
+#include <stdexcept>
+
+#include "config.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace config {
+
+namespace {
+
+// NOLINTNEXTLINE
+auto thread_count = kThreadCount;
+
+auto ParseKind(std::string_view name) -> Schedule::Kind {
+  if (name == "static") {
+    return Schedule::Kind::kStatic;
+  }
+  if (name == "dynamic") {
+    return Schedule::Kind::kDynamic;
+  }
+  if (name == "guided") {
+    return Schedule::Kind::kGuided;
+  }
+  throw std::invalid_argument("Unknown schedule: " + std::string{name});
+}
+
+auto ToOpenMp(Schedule::Kind kind) -> omp_sched_t {
+  switch (kind) {
+    case Schedule::Kind::kStatic:
+      return omp_sched_static;
+    case Schedule::Kind::kDynamic:
+      return omp_sched_dynamic;
+    case Schedule::Kind::kGuided:
+      return omp_sched_guided;
+  }
+  return omp_sched_guided;
+}
+
+}  // namespace
+
+auto ThreadCount() -> int {
+  return thread_count;
+}
+
+auto SetThreadCount(int count) -> void {
+  if (count <= 0) {
+    throw std::invalid_argument("Thread count must be positive");
+  }
+  thread_count = count;
+}
+
+auto SetSchedule(const Schedule& schedule) -> void {
+  omp_set_schedule(ToOpenMp(schedule.kind), schedule.chunk);
+}
+
+auto ParseSchedule(std::string_view name) -> Schedule {
+  auto schedule = Schedule{};
+
+  auto colon = name.find(':');
+  schedule.kind = ParseKind(name.substr(0, colon));
+  if (colon != std::string_view::npos) {
+    schedule.chunk = std::stoi(std::string{name.substr(colon + 1)});
+    if (schedule.chunk <= 0) {
+      throw std::invalid_argument("Schedule chunk must be positive");
+    }
+  }
+
+  return schedule;
+}
+
+auto ToString(const Schedule& schedule) -> std::string {
+  auto name = std::string{};
+  switch (schedule.kind) {
+    case Schedule::Kind::kStatic:
+      name = "static";
+      break;
+    case Schedule::Kind::kDynamic:
+      name = "dynamic";
+      break;
+    case Schedule::Kind::kGuided:
+      name = "guided";
+      break;
+  }
+
+  if (schedule.chunk != 0) {
+    name += ':' + std::to_string(schedule.chunk);
+  }
+  return name;
+}
+
+}  // namespace config
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 namespace config {
 
@@ -12,8 +17,37 @@ using Clock = std::chrono::steady_clock;
 using Mcs = std::chrono::microseconds;
 using Durations = std::vector<std::result_of_t<decltype (&Mcs::count)(Mcs)>>;
 
+inline auto Since(Clock::time_point start) -> Mcs {
+  return std::chrono::duration_cast<Mcs>(Clock::now() - start);
+}
+
 constexpr auto kTestCount = 5;
-constexpr auto kThreadCount = 4;
+constexpr auto kThreadCount = 4;  // default of `ThreadCount()`
+
+// Threads of every parallel region, changed at runtime by `--threads=<n>`
+// and benchmark sweeps.
+auto ThreadCount() -> int;
+auto SetThreadCount(int count) -> void;
+
+// Policy of loops with `schedule(runtime)`: the ones over points whose cost
+// varies (bound-based engines skip most of them). Loops over fixed ranges
+// stay `schedule(static)`. Zero `chunk` is the OpenMP default chunk.
+// Until `SetSchedule` is called they follow `OMP_SCHEDULE`.
+struct Schedule {
+  enum class Kind { kStatic, kDynamic, kGuided };
+
+  Kind kind{Kind::kGuided};
+  int chunk{0};
+};
+
+auto SetSchedule(const Schedule& schedule) -> void;
+
+// "static", "dynamic" or "guided", optionally followed by ":<chunk>".
+auto ParseSchedule(std::string_view name) -> Schedule;
+auto ToString(const Schedule& schedule) -> std::string;
+
+// Points handed to the assignment kernel at once.
+constexpr auto kBlockSize = Size{256};
 
 #if __cpp_lib_hardware_interference_size > 201703L
 
@@ -0,0 +1,42 @@
+#include <utility>
+
+#include "convergence.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+Convergence::Convergence(StopRules rules, config::Size point_count,
+                         config::Size iterations)
+    : rules_(rules), point_count_(point_count), iterations_(iterations) {
+}
+
+auto Convergence::Done(const StepStats& stats, bool moved) -> bool {
+  ++iterations_;
+
+  auto ratio = static_cast<double>(stats.changed) /
+               static_cast<double>(point_count_);
+  auto improvement = (inertia_ - stats.inertia) / stats.inertia;
+  // Labels of the first iteration are compared to no labels at all.
+  auto first = std::exchange(first_, false);
+  inertia_ = stats.inertia;
+
+  if (!moved) {
+    reason_ = "centroids settled";
+  } else if (rules_.unchanged && stats.changed == 0) {
+    reason_ = "no changes";
+  } else if (!first && rules_.change_ratio > 0 &&
+             ratio < rules_.change_ratio) {
+    reason_ = "change ratio";
+  } else if (!first && rules_.inertia_tolerance > 0 &&
+             improvement < rules_.inertia_tolerance) {
+    reason_ = "inertia improvement";
+  } else if (rules_.max_iterations != 0 &&
+             iterations_ >= rules_.max_iterations) {
+    reason_ = "max iterations";
+  }
+
+  return !reason_.empty();
+}
+
+auto Convergence::Reason() const -> std::string_view {
+  return reason_;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string_view>
+
+#include "config.hpp"
+#include "engine.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Optional rules to stop before centroids settle completely. Iterating
+// always stops once no centroid moves; any enabled rule may stop earlier.
+struct StopRules {
+  config::Size max_iterations{0};  // zero disables
+  bool unchanged{false};           // no point changed cluster
+  double change_ratio{0};          // share of changed points is below
+  double inertia_tolerance{0};     // relative inertia improvement is below
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Evaluates `StopRules` after every iteration from the statistics of its
+// assignment pass, so no extra pass over points is needed.
+class Convergence {
+ public:
+  // `iterations` already run by a resumed run count towards
+  // `StopRules::max_iterations`.
+  Convergence(StopRules rules, config::Size point_count,
+              config::Size iterations = 0);
+
+  // Returns whether to stop after an iteration with `stats`,
+  // `moved` tells whether any centroid has moved.
+  auto Done(const StepStats& stats, bool moved) -> bool;
+
+  // Rule which stopped iterating, empty before that.
+  auto Reason() const -> std::string_view;
+
+ private:
+  StopRules rules_;
+  config::Size point_count_;
+
+  config::Size iterations_;
+  bool first_{true};
+  double inertia_{0};  // of the previous iteration
+  std::string_view reason_;
+};
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "coreset.hpp"
+#include "random.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// Points sharing one partial sum, and draws sharing one random generator.
+constexpr auto kCoresetBlock = config::Size{4096};
+
+auto BlockCount(config::Size n) -> config::Size {
+  return (n + kCoresetBlock - 1) / kCoresetBlock;
+}
+
+// Sum of `term(i)` over `[0, n)`, taken block by block in a fixed order.
+template <typename Term>
+auto BlockSum(config::Size n, Term term) -> double {
+  auto sums = std::vector<double>(BlockCount(n), 0);
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto b = config::Index{0}; b < sums.size(); ++b) {
+    auto sum = 0.0;
+    for (auto i = b * kCoresetBlock; i < std::min(n, (b + 1) * kCoresetBlock);
+         ++i) {
+      sum += term(i);
+    }
+    sums[b] = sum;
+  }
+
+  auto total = 0.0;
+  for (auto s : sums) {
+    total += s;
+  }
+  return total;
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto BuildCoreset(const Points& points, config::Size size, std::uint64_t seed)
+    -> Points {
+  const auto n = points.size();
+  if (n == 0 || size == 0) {
+    throw std::invalid_argument("Empty coreset");
+  }
+
+  const auto count = static_cast<double>(n);
+  auto mean = Point{};
+  mean.x = BlockSum(n, [&](config::Index i) { return points[i].x; }) / count;
+  mean.y = BlockSum(n, [&](config::Index i) { return points[i].y; }) / count;
+
+  // Mass of every point proportional to `q`, accumulated into `cumulative`
+  // so that a draw is a binary search. Blocks are scanned in parallel and
+  // shifted by the totals of the blocks before them.
+  auto mass = std::vector<double>(n);
+  auto dist = BlockSum(n, [&](config::Index i) {
+    auto dx = points[i].x - mean.x;
+    auto dy = points[i].y - mean.y;
+    return mass[i] = dx * dx + dy * dy;
+  });
+  // All points coincide: the coreset is uniform.
+  const auto floor = dist > 0 ? dist / count : 1.0;
+
+  const auto blocks = BlockCount(n);
+  auto cumulative = std::vector<double>(n);
+  auto offsets = std::vector<double>(blocks + 1, 0);
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto b = config::Index{0}; b < blocks; ++b) {
+    auto sum = 0.0;
+    for (auto i = b * kCoresetBlock; i < std::min(n, (b + 1) * kCoresetBlock);
+         ++i) {
+      mass[i] += floor;
+      cumulative[i] = (sum += mass[i]);
+    }
+    offsets[b + 1] = sum;
+  }
+
+  for (auto b = config::Index{0}; b < blocks; ++b) {
+    offsets[b + 1] += offsets[b];
+  }
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto b = config::Index{1}; b < blocks; ++b) {
+    for (auto i = b * kCoresetBlock; i < std::min(n, (b + 1) * kCoresetBlock);
+         ++i) {
+      cumulative[i] += offsets[b];
+    }
+  }
+
+  const auto total = offsets[blocks];
+  const auto draws = static_cast<double>(size);
+
+  auto coreset = Points(size);
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto b = config::Index{0}; b < BlockCount(size); ++b) {
+    auto random = Random{seed, 0, b};
+    for (auto i = b * kCoresetBlock;
+         i < std::min(size, (b + 1) * kCoresetBlock); ++i) {
+      auto target = random.Uniform() * total;
+      auto p = static_cast<config::Index>(
+          std::upper_bound(cumulative.begin(), cumulative.end(), target) -
+          cumulative.begin());
+      p = std::min(p, n - 1);  // rounding of the last sum
+
+      coreset[i].x = points[p].x;
+      coreset[i].y = points[p].y;
+      coreset[i].weight = total / (draws * mass[p]);
+    }
+  }
+
+  return coreset;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+#include "config.hpp"
+#include "cluster.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Lightweight coreset (Bachem, Lucic and Krause, 2018): `size` points drawn
+// with replacement, point `x` with probability
+// `q(x) = 1 / 2n + d(x, mean)^2 / 2 sum d^2`, and weighted `1 / (size q(x))`,
+// so that weighted sums over the coreset estimate sums over all `points`
+// without bias. Far points are oversampled and weigh less, which keeps
+// small clusters far from the mean represented.
+//
+// Reproducible from `seed` alone: draws are bound to fixed blocks of the
+// sample and sums are taken in block order.
+auto BuildCoreset(const Points& points, config::Size size, std::uint64_t seed)
+    -> Points;
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "config.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+class MappedFile;
+
+struct DatasetHeader {
+  config::Size point_count{0};
+  config::Size cluster_count{0};
+  config::Size dimension{2};
+  bool sparse{false};  // rows of `column:value` pairs, see `SparseDataset`
+};
+
+// Dimension only known at run time.
+constexpr auto kDynamic = config::Size{0};
+
+// Dimensions with kernels specialized at compile time.
+using Dimensions =
+    std::integer_sequence<config::Size, 2, 3, 4, 8, 16, 32, 64, 128>;
+
+// Calls `visit(std::integral_constant<config::Size, D>{})` with `D` equal to
+// `dim` if it is one of `Dimensions`, and to `kDynamic` otherwise.
+template <typename Visit>
+auto VisitDimension(config::Size dim, Visit&& visit) -> void {
+  auto matched = [&]<config::Size... Ds>(std::integer_sequence<config::Size,
+                                                              Ds...>) {
+    return ((dim == Ds &&
+             (visit(std::integral_constant<config::Size, Ds>{}), true)) ||
+            ...);
+  }(Dimensions{});
+
+  if (!matched) {
+    visit(std::integral_constant<config::Size, kDynamic>{});
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Row-major coordinates of points of any dimension. Either owns them
+// (parsed from text) or borrows them from a mapping of a binary file.
+class DenseDataset {
+ public:
+  DenseDataset(DatasetHeader header, std::vector<double> coords);
+  DenseDataset(DatasetHeader header, std::shared_ptr<const MappedFile> file,
+               const double* coords);
+
+  auto Header() const -> const DatasetHeader&;
+  auto Coords() const -> const double*;
+
+ private:
+  DatasetHeader header_;
+  std::vector<double> storage_;
+  std::shared_ptr<const MappedFile> file_;
+  const double* coords_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Rows in compressed sparse row (CSR) layout: row `p` holds `values[i]` in
+// column `columns[i]` for every `i` in `[row_starts[p], row_starts[p + 1])`.
+struct SparseDataset {
+  DatasetHeader header;
+  std::vector<config::Size> row_starts;  // `point_count + 1` of them
+  std::vector<std::uint32_t> columns;
+  std::vector<double> values;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Typed access to row-major coordinates of type `T` with dimension `D`
+// fixed at compile time, or read from the header for `kDynamic`.
+template <config::Size D, typename T = double>
+class DatasetView {
+ public:
+  explicit DatasetView(const DenseDataset& data)
+    requires std::is_same_v<T, double>
+      : DatasetView(data.Coords(), data.Header().point_count,
+                    data.Header().dimension) {
+  }
+
+  DatasetView(const T* coords, config::Size size, config::Size dim)
+      : coords_(coords), size_(size), dim_(dim) {
+  }
+
+  auto Dim() const -> config::Size {
+    if constexpr (D == kDynamic) {
+      return dim_;
+    } else {
+      return D;
+    }
+  }
+
+  auto Size() const -> config::Size {
+    return size_;
+  }
+
+  auto Row(config::Index i) const -> const T* {
+    return coords_ + i * Dim();
+  }
+
+ private:
+  const T* coords_;
+  config::Size size_;
+  config::Size dim_;
+};
@@ -0,0 +1,329 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "dbscan.hpp"
+#include "io.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr auto kNone = std::numeric_limits<config::Index>::max();
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+DbscanSolver::DbscanSolver(Params params) : params_(params) {
+  if (!(params_.eps > 0)) {
+    throw std::invalid_argument("DBSCAN needs a positive eps");
+  }
+  if (params_.min_points == 0) {
+    throw std::invalid_argument("DBSCAN needs a positive min points");
+  }
+}
+
+auto DbscanSolver::Solve(const std::string& input, const std::string& output)
+    -> void {
+  report_ = {};
+
+  auto start = config::Clock::now();
+  Read(input);
+  report_.read = config::Since(start);
+
+  start = config::Clock::now();
+  BuildGrid();
+  MarkCore();
+  Merge();
+  Label();
+  report_.assign = config::Since(start);
+
+  start = config::Clock::now();
+  Write(output);
+  report_.write = config::Since(start);
+}
+
+auto DbscanSolver::LastReport() const -> const Report& {
+  return report_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto DbscanSolver::Read(const std::string& input) -> void {
+  ReadDataset(input, points_);  // the number of clusters is not used
+}
+
+auto DbscanSolver::BuildGrid() -> void {
+  const auto n = points_.size();
+  const auto eps = params_.eps;
+
+  auto min_x = std::numeric_limits<double>::infinity();
+  auto min_y = min_x;
+  auto max_x = -min_x;
+  auto max_y = -min_x;
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static) reduction(min:min_x, min_y) reduction(max:max_x, max_y)
+  for (auto p = config::Index{0}; p < n; ++p) {
+    min_x = std::min(min_x, points_[p].x);
+    min_y = std::min(min_y, points_[p].y);
+    max_x = std::max(max_x, points_[p].x);
+    max_y = std::max(max_y, points_[p].y);
+  }
+
+  // Cell keys, including those of the row past the last one looked up by
+  // `Neighbors`, must fit in 64 bits to keep grid order.
+  auto cells = ((max_x - min_x) / eps + 1) * ((max_y - min_y) / eps + 2);
+  if (!(cells < 0x1p63)) {
+    throw std::invalid_argument("DBSCAN eps too small for the data extent");
+  }
+
+  columns_ = static_cast<config::Size>((max_x - min_x) / eps) + 1;
+
+  auto keys = std::vector<std::pair<std::uint64_t, config::Index>>(n);
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto p = config::Index{0}; p < n; ++p) {
+    auto column = static_cast<std::uint64_t>((points_[p].x - min_x) / eps);
+    auto row = static_cast<std::uint64_t>((points_[p].y - min_y) / eps);
+    keys[p] = {row * columns_ + column, p};
+  }
+
+  std::sort(keys.begin(), keys.end());
+
+  x_.resize(n);
+  y_.resize(n);
+  order_.resize(n);
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto i = config::Index{0}; i < n; ++i) {
+    order_[i] = keys[i].second;
+    x_[i] = points_[order_[i]].x;
+    y_[i] = points_[order_[i]].y;
+  }
+
+  cell_keys_.clear();
+  cell_starts_.clear();
+  for (auto i = config::Index{0}; i < n; ++i) {
+    if (i == 0 || keys[i].first != keys[i - 1].first) {
+      cell_keys_.push_back(keys[i].first);
+      cell_starts_.push_back(i);
+    }
+  }
+  cell_starts_.push_back(n);
+}
+
+auto DbscanSolver::Neighbors(config::Index cell) const -> Neighborhood {
+  auto result = Neighborhood{};
+
+  const auto key = cell_keys_[cell];
+  const auto row = key / columns_;
+  const auto column = key % columns_;
+
+  for (auto r = row == 0 ? row : row - 1; r <= row + 1; ++r) {
+    auto first = r * columns_ + (column == 0 ? column : column - 1);
+    auto last = r * columns_ + std::min(column + 1, columns_ - 1);
+
+    // Cells of a row are adjacent in grid order.
+    auto it = std::lower_bound(cell_keys_.begin(), cell_keys_.end(), first);
+    for (; it != cell_keys_.end() && *it <= last; ++it) {
+      result.cells[result.count++] =
+          static_cast<config::Index>(it - cell_keys_.begin());
+    }
+  }
+
+  return result;
+}
+
+auto DbscanSolver::MarkCore() -> void {
+  const auto eps2 = params_.eps * params_.eps;
+  const auto cells = cell_keys_.size();
+
+  core_.assign(x_.size(), 0);
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(dynamic)
+  for (auto cell = config::Index{0}; cell < cells; ++cell) {
+    auto around = Neighbors(cell);
+
+    for (auto p = cell_starts_[cell]; p < cell_starts_[cell + 1]; ++p) {
+      auto count = config::Size{0};
+
+      for (auto i = config::Index{0};
+           i < around.count && count < params_.min_points; ++i) {
+        auto other = around.cells[i];
+        for (auto q = cell_starts_[other]; q < cell_starts_[other + 1]; ++q) {
+          auto dx = x_[p] - x_[q];
+          auto dy = y_[p] - y_[q];
+          count += dx * dx + dy * dy <= eps2 ? 1 : 0;
+        }
+      }
+
+      core_[p] = count >= params_.min_points ? 1 : 0;
+    }
+  }
+}
+
+auto DbscanSolver::Merge() -> void {
+  const auto eps2 = params_.eps * params_.eps;
+  const auto n = x_.size();
+  const auto cells = cell_keys_.size();
+
+  parent_ = std::vector<std::atomic<config::Index>>(n);
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto p = config::Index{0}; p < n; ++p) {
+    parent_[p].store(p, std::memory_order_relaxed);
+  }
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(dynamic)
+  for (auto cell = config::Index{0}; cell < cells; ++cell) {
+    auto around = Neighbors(cell);
+
+    for (auto p = cell_starts_[cell]; p < cell_starts_[cell + 1]; ++p) {
+      if (core_[p] == 0) {
+        continue;
+      }
+
+      for (auto i = config::Index{0}; i < around.count; ++i) {
+        auto other = around.cells[i];
+        // Every pair of cells is merged from the lower one.
+        if (other < cell) {
+          continue;
+        }
+
+        for (auto q = cell_starts_[other]; q < cell_starts_[other + 1]; ++q) {
+          auto dx = x_[p] - x_[q];
+          auto dy = y_[p] - y_[q];
+          if (q > p && core_[q] != 0 && dx * dx + dy * dy <= eps2) {
+            Union(p, q);
+          }
+        }
+      }
+    }
+  }
+}
+
+auto DbscanSolver::Label() -> void {
+  const auto eps2 = params_.eps * params_.eps;
+  const auto n = x_.size();
+  const auto cells = cell_keys_.size();
+
+  // Root of the cluster of every point, by position in `points_`.
+  auto roots = std::vector<config::Index>(n, kNone);
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(dynamic)
+  for (auto cell = config::Index{0}; cell < cells; ++cell) {
+    auto around = Neighbors(cell);
+
+    for (auto p = cell_starts_[cell]; p < cell_starts_[cell + 1]; ++p) {
+      if (core_[p] != 0) {
+        roots[order_[p]] = Find(p);
+        continue;
+      }
+
+      // Border points join their nearest core point, ties going to the
+      // lowest position, so the result does not depend on scheduling.
+      auto nearest = kNone;
+      auto min_dist = eps2;
+      for (auto i = config::Index{0}; i < around.count; ++i) {
+        auto other = around.cells[i];
+        for (auto q = cell_starts_[other]; q < cell_starts_[other + 1]; ++q) {
+          auto dx = x_[p] - x_[q];
+          auto dy = y_[p] - y_[q];
+          if (auto d = dx * dx + dy * dy; core_[q] != 0 && d <= min_dist &&
+                                          (d < min_dist || q < nearest)) {
+            nearest = q;
+            min_dist = d;
+          }
+        }
+      }
+
+      if (nearest != kNone) {
+        roots[order_[p]] = Find(nearest);
+      }
+    }
+  }
+
+  // Numbering in file order is sequential, but a single cheap pass.
+  auto ids = std::vector<config::Index>(n, kNone);
+  auto count = config::Size{0};
+  for (auto p = config::Index{0}; p < n; ++p) {
+    if (roots[p] != kNone && ids[roots[p]] == kNone) {
+      ids[roots[p]] = count++;
+    }
+  }
+
+  clusters_.assign(count, Cluster{});
+  auto sums = std::vector<double>(2 * count, 0);
+  auto sizes = std::vector<double>(count, 0);
+
+  for (auto p = config::Index{0}; p < n; ++p) {
+    auto& point = points_[p];
+    if (roots[p] == kNone) {
+      point.cluster_index = count;
+      continue;
+    }
+
+    auto c = ids[roots[p]];
+    point.cluster_index = c;
+    sums[2 * c] += point.x;
+    sums[2 * c + 1] += point.y;
+    sizes[c] += 1;
+  }
+
+  for (auto c = config::Index{0}; c < count; ++c) {
+    clusters_[c].Centroid().x = sums[2 * c] / sizes[c];
+    clusters_[c].Centroid().y = sums[2 * c + 1] / sizes[c];
+  }
+}
+
+auto DbscanSolver::Find(config::Index p) -> config::Index {
+  while (true) {
+    auto parent = parent_[p].load(std::memory_order_relaxed);
+    if (parent == p) {
+      return p;
+    }
+
+    auto grand = parent_[parent].load(std::memory_order_relaxed);
+    if (grand != parent) {
+      // Another thread may have shortened the path already, `grand` is
+      // an ancestor of `p` either way.
+      parent_[p].compare_exchange_weak(parent, grand,
+                                       std::memory_order_relaxed);
+    }
+    p = grand;
+  }
+}
+
+auto DbscanSolver::Union(config::Index a, config::Index b) -> void {
+  while (true) {
+    a = Find(a);
+    b = Find(b);
+    if (a == b) {
+      return;
+    }
+    if (a < b) {
+      std::swap(a, b);
+    }
+
+    // Fails if `a` stopped being a root meanwhile, then retry from there.
+    auto expected = a;
+    if (parent_[a].compare_exchange_strong(expected, b,
+                                           std::memory_order_relaxed)) {
+      return;
+    }
+  }
+}
+
+auto DbscanSolver::Write(const std::string& output) -> void {
+  WriteResult(output, clusters_, points_);
+}
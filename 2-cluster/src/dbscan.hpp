@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+#include "cluster.hpp"
+#include "params.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// DBSCAN (Ester et al., 1996) over 2D points: a point with at least
+// `Params::min_points` points (itself included) within `Params::eps` is a
+// core point, core points within `eps` of each other share a cluster, other
+// points join the cluster of their nearest core point within `eps` or are
+// noise. Neighbours are looked up in a uniform grid of `eps`-sized cells,
+// so only the 3 x 3 cells around a point are scanned. Clusters are formed by
+// a lock-free union-find merged concurrently, cells run in parallel.
+//
+// Clusters are numbered in the order their first point appears in the file,
+// centroids written are their means and noise is labelled with the number of
+// clusters, one past the last centroid. Labels do not depend on the thread
+// count.
+class DbscanSolver {
+ public:
+  explicit DbscanSolver(Params params);
+
+  auto Solve(const std::string& input, const std::string& output) -> void;
+
+  // `assign` covers all of the clustering, `history` stays empty.
+  auto LastReport() const -> const Report&;
+
+ private:
+  // Up to 9 non-empty cells around a cell, itself included.
+  struct Neighborhood {
+    std::array<config::Index, 9> cells{};
+    config::Size count{0};
+  };
+
+  auto Read(const std::string& input) -> void;
+
+  // Sorts points by cell, into `x_`, `y_` and `order_`.
+  auto BuildGrid() -> void;
+  auto Neighbors(config::Index cell) const -> Neighborhood;
+
+  auto MarkCore() -> void;
+  auto Merge() -> void;
+  auto Label() -> void;
+
+  // Lock-free union-find over positions in grid order: roots are only
+  // linked below smaller roots, by compare-and-swap, and finds halve paths.
+  auto Find(config::Index p) -> config::Index;
+  auto Union(config::Index a, config::Index b) -> void;
+
+  auto Write(const std::string& output) -> void;
+
+ private:
+  Params params_;
+  Report report_;
+
+  Points points_;
+  Clusters clusters_;
+
+  // Points in grid order: coordinates and position in `points_`.
+  std::vector<double> x_;
+  std::vector<double> y_;
+  std::vector<config::Index> order_;
+
+  // Non-empty cells in grid order, row by row: their keys and first points,
+  // plus the end of the last cell.
+  std::vector<std::uint64_t> cell_keys_;
+  std::vector<config::Index> cell_starts_;
+  config::Size columns_{0};
+
+  std::vector<std::uint8_t> core_;
+  std::vector<std::atomic<config::Index>> parent_;
+};
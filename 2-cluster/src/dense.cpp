@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_set>
+
+#include "dense.hpp"
+#include "io.hpp"
+#include "reduction.hpp"
+#include "trace.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+auto ToFloat(const DenseDataset& data) -> std::vector<float> {
+  const auto size = data.Header().point_count * data.Header().dimension;
+  const auto* coords = data.Coords();
+  auto floats = std::vector<float>(size);
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto i = config::Index{0}; i < size; ++i) {
+    floats[i] = static_cast<float>(coords[i]);
+  }
+
+  return floats;
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+DenseSolver::DenseSolver(Params params) : params_(params) {
+  if (params_.mode != Mode::kLloyd && params_.mode != Mode::kGemm) {
+    throw std::invalid_argument(
+        "Only lloyd and gemm engines support points of dimension other than 2");
+  }
+  if (params_.seeding != Seeding::kRandom) {
+    throw std::invalid_argument(
+        "Only random seeding supports points of dimension other than 2");
+  }
+  if (params_.order != Order::kNone) {
+    throw std::invalid_argument("Reordering supports the 2D point path only");
+  }
+  if (params_.coreset_size != 0) {
+    throw std::invalid_argument("Coresets support the 2D point path only");
+  }
+  if (params_.mode == Mode::kGemm && params_.precision != Precision::kDouble) {
+    throw std::invalid_argument("gemm engine supports double precision only");
+  }
+}
+
+auto DenseSolver::Solve(const std::string& input, const std::string& output)
+    -> void {
+  report_ = {};
+
+  auto start = config::Clock::now();
+  auto data = ReadDense(input);
+  report_.read = config::Since(start);
+
+  const auto& header = data.Header();
+  k_ = header.cluster_count;
+  labels_.assign(header.point_count, 0);
+
+  // Float coordinates are converted once, the cost is part of reading.
+  auto floats = std::vector<float>{};
+  if (params_.precision != Precision::kDouble) {
+    start = config::Clock::now();
+    floats = ToFloat(data);
+    report_.read += config::Since(start);
+  }
+
+  VisitDimension(header.dimension, [&](auto dim) {
+    constexpr auto kDim = decltype(dim)::value;
+    auto rows = DatasetView<kDim, float>{floats.data(), header.point_count,
+                                         header.dimension};
+
+    switch (params_.precision) {
+      case Precision::kDouble:
+        Run<double>(DatasetView<kDim>{data});
+        break;
+      case Precision::kFloat:
+        Run<float>(rows);
+        break;
+      case Precision::kMixed:
+        Run<double>(rows);
+        break;
+    }
+  });
+
+  start = config::Clock::now();
+  WriteResult(output, centroids_, header.dimension, labels_);
+  report_.write = config::Since(start);
+}
+
+auto DenseSolver::LastReport() const -> const Report& {
+  return report_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename Sum, config::Size D, typename T>
+auto DenseSolver::Run(const DatasetView<D, T>& points) -> void {
+  auto start = config::Clock::now();
+  ChooseCentroids(points);
+  report_.seeding = config::Since(start);
+
+  auto convergence = Convergence{params_.stop, points.Size()};
+
+  auto done = false;
+  while (!done) {
+    auto stats = StepStats{points.Size() * k_, 0};
+    auto moved = Step<Sum>(points, stats);
+    TRACE_ITERATION(stats);
+    report_.history.push_back(stats);
+    done = convergence.Done(stats, moved);
+  }
+
+  report_.stop_reason = convergence.Reason();
+
+  report_.inertia = ComputeInertia(points);
+}
+
+// Use of `rand()` here is intentional, just like in 2D.
+template <config::Size D, typename T>
+auto DenseSolver::ChooseCentroids(const DatasetView<D, T>& points) -> void {
+  if (points.Size() < k_) {
+    throw std::invalid_argument("Fewer points than clusters");
+  }
+
+  const auto dim = points.Dim();
+  auto used = std::unordered_set<config::Index>{};
+  centroids_.clear();
+
+  while (used.size() < k_) {
+    auto p = static_cast<config::Index>(std::rand()) % points.Size();
+    if (used.find(p) != std::end(used)) {
+      continue;
+    }
+
+    centroids_.insert(std::end(centroids_), points.Row(p),
+                      points.Row(p) + dim);
+    used.insert(p);
+  }
+}
+
+template <typename Sum, config::Size D, typename T>
+auto DenseSolver::Step(const DatasetView<D, T>& points, StepStats& stats)
+    -> bool {
+  const auto dim = points.Dim();
+  const auto n = points.Size();
+  // A fixed number of ranges makes sums independent of the thread count.
+  const auto ranges = params_.deterministic
+                          ? reduction::kGroups
+                          : static_cast<config::Size>(config::ThreadCount());
+
+  auto& table = std::get<BasicCentroidTable<T>>(tables_);
+  const auto gemm = params_.mode == Mode::kGemm;
+  if (gemm) {
+    gemm_.Load(centroids_, dim);
+  } else {
+    table.Load(centroids_, dim);
+  }
+
+  // Every range of points accumulates into its own sums, so no atomics
+  // are needed; ranges are merged in a fixed order afterwards.
+  auto sums = std::vector<std::vector<Sum>>(ranges);
+  auto counts = std::vector<std::vector<config::Size>>(ranges);
+  auto losses = std::vector<double>(ranges, 0);
+
+  auto changed = config::Size{0};
+
+  auto start = config::Clock::now();
+  TRACE_BEGIN("assign");
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static) reduction(+:changed)
+  for (auto r = config::Index{0}; r < ranges; ++r) {
+    TRACE_WORK();
+    auto& sum = sums[r];
+    auto& count = counts[r];
+    auto loss = 0.0;
+    sum.assign(k_ * dim, 0);
+    count.assign(k_, 0);
+
+    auto last = (r + 1) * n / ranges;
+    for (auto first = r * n / ranges; first < last;
+         first += config::kBlockSize) {
+      auto size = std::min(config::kBlockSize, last - first);
+
+      // Labels of the last iteration, compared in the accumulation loop.
+      auto previous = std::array<config::Index, config::kBlockSize>{};
+      std::copy_n(&labels_[first], size, previous.begin());
+
+      if (gemm) {
+        if constexpr (std::is_same_v<T, double>) {
+          kernels::AssignNearestGemm(gemm_, points.Row(first), size,
+                                     &labels_[first]);
+        }
+      } else {
+        kernels::AssignNearest<D>(table, points.Row(first), size,
+                                  &labels_[first]);
+      }
+
+      for (auto p = first; p < first + size; ++p) {
+        const auto* row = points.Row(p);
+        const auto* centroid = &centroids_[labels_[p] * dim];
+        auto* target = &sum[labels_[p] * dim];
+        for (auto d = config::Index{0}; d < dim; ++d) {
+          auto diff = static_cast<double>(row[d]) - centroid[d];
+          loss += diff * diff;
+          target[d] += static_cast<Sum>(row[d]);
+        }
+        ++count[labels_[p]];
+        if (labels_[p] != previous[p - first]) {
+          ++changed;
+        }
+      }
+    }
+
+    losses[r] = loss;
+  }
+
+  stats.changed = changed;
+  stats.inertia = reduction::PairwiseSum(losses);
+
+  TRACE_END();
+  report_.assign += config::Since(start);
+  start = config::Clock::now();
+  TRACE_BEGIN("update");
+
+  auto updated = false;
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static) reduction(|:updated)
+  for (auto c = config::Index{0}; c < k_; ++c) {
+    TRACE_WORK();
+    auto size = config::Size{0};
+    for (auto r = config::Index{0}; r < ranges; ++r) {
+      size += counts[r][c];
+    }
+
+    // Empty clusters keep their centroid.
+    if (size == 0) {
+      continue;
+    }
+
+    auto moved = 0.0;
+    for (auto d = config::Index{0}; d < dim; ++d) {
+      auto sum = 0.0;
+      for (auto r = config::Index{0}; r < ranges; ++r) {
+        sum += static_cast<double>(sums[r][c * dim + d]);
+      }
+
+      auto mean = sum / static_cast<double>(size);
+      auto diff = mean - centroids_[c * dim + d];
+      moved += diff * diff;
+      centroids_[c * dim + d] = mean;
+    }
+
+    updated |= std::sqrt(moved) > 1e-6;
+  }
+
+  TRACE_END();
+  report_.update += config::Since(start);
+
+  return updated;
+}
+
+template <config::Size D, typename T>
+auto DenseSolver::ComputeInertia(const DatasetView<D, T>& points) const
+    -> double {
+  const auto dim = points.Dim();
+
+  if (params_.deterministic) {
+    return reduction::Sum(points.Size(), [&](config::Index p) {
+      const auto* row = points.Row(p);
+      const auto* centroid = &centroids_[labels_[p] * dim];
+      auto inertia = 0.0;
+      for (auto d = config::Index{0}; d < dim; ++d) {
+        auto diff = static_cast<double>(row[d]) - centroid[d];
+        inertia += diff * diff;
+      }
+      return inertia;
+    });
+  }
+
+  auto inertia = 0.0;
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static) reduction(+:inertia)
+  for (auto p = config::Index{0}; p < points.Size(); ++p) {
+    const auto* row = points.Row(p);
+    const auto* centroid = &centroids_[labels_[p] * dim];
+    for (auto d = config::Index{0}; d < dim; ++d) {
+      auto diff = static_cast<double>(row[d]) - centroid[d];
+      inertia += diff * diff;
+    }
+  }
+
+  return inertia;
+}
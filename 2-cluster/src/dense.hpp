@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "config.hpp"
+#include "dataset.hpp"
+#include "gemm.hpp"
+#include "kernels.hpp"
+#include "params.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Lloyd's algorithm on row-major points of any dimension. Datasets with one
+// of `Dimensions` run code specialized for it, so distance loops are fully
+// unrolled; others run the same code with the dimension read at run time.
+// Points are assigned either by the direct kernel (`Mode::kLloyd`) or
+// the GEMM one (`Mode::kGemm`), seeding is `Seeding::kRandom` only.
+// With `Precision::kFloat` or `kMixed` the direct kernel runs on a float
+// copy of coordinates, twice as many per vector; sums of clusters are
+// accumulated in `Sum`: float or double respectively.
+class DenseSolver {
+ public:
+  explicit DenseSolver(Params params);
+
+  auto Solve(const std::string& input, const std::string& output) -> void;
+
+  auto LastReport() const -> const Report&;
+
+ private:
+  template <typename Sum, config::Size D, typename T>
+  auto Run(const DatasetView<D, T>& points) -> void;
+
+  template <config::Size D, typename T>
+  auto ChooseCentroids(const DatasetView<D, T>& points) -> void;
+
+  // Assigns points and moves centroids to the means of their clusters,
+  // returns whether any centroid moved. Fills changes and inertia of `stats`.
+  template <typename Sum, config::Size D, typename T>
+  auto Step(const DatasetView<D, T>& points, StepStats& stats) -> bool;
+
+  template <config::Size D, typename T>
+  auto ComputeInertia(const DatasetView<D, T>& points) const -> double;
+
+ private:
+  Params params_;
+  Report report_;
+
+  config::Size k_{0};
+  std::vector<double> centroids_;  // row-major, `k_` rows
+  std::vector<config::Index> labels_;
+  std::tuple<CentroidTable, BasicCentroidTable<float>> tables_;
+  GemmCentroids gemm_;
+};
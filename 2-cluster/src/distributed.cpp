@@ -0,0 +1,226 @@
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <unordered_set>
+
+#include <mpi.h>
+
+#include "distributed.hpp"
+#include "io.hpp"
+#include "macros.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+static_assert(sizeof(config::Index) == sizeof(std::uint64_t));
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+DistributedSolver::DistributedSolver(Params params) : params_(params) {
+  if (params_.seeding != Seeding::kRandom) {
+    throw std::invalid_argument("Distributed mode supports random seeding only");
+  }
+
+  EXPECT_OK(MPI_Comm_rank(MPI_COMM_WORLD, &rank_));
+  EXPECT_OK(MPI_Comm_size(MPI_COMM_WORLD, &ranks_));
+}
+
+auto DistributedSolver::Solve(const std::string& input,
+                              const std::string& output) -> void {
+  Read(input);
+
+  report_ = {};
+
+  auto start = config::Clock::now();
+  ChooseCentroids();
+  report_.seeding =
+      std::chrono::duration_cast<config::Mcs>(config::Clock::now() - start);
+
+  auto engine = MakeEngine(params_.mode, points_, clusters_);
+
+  auto convergence = Convergence{params_.stop, total_};
+
+  auto done = false;
+  while (!done) {
+    engine->Assign();
+    ReduceSums();
+    done = Converge(*engine, engine->Update(), convergence);
+  }
+
+  report_.stop_reason = convergence.Reason();
+
+  report_.inertia = ComputeInertia();
+
+  Write(output);
+}
+
+auto DistributedSolver::LastReport() const -> const Report& {
+  return report_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto DistributedSolver::Read(const std::string& input) -> void {
+  auto shard = static_cast<config::Index>(rank_);
+  auto shards = static_cast<config::Size>(ranks_);
+  auto header = ReadShard(input, shard, shards, points_);
+
+  clusters_.assign(header.cluster_count, Cluster{});
+  total_ = header.point_count;
+
+  auto local = std::uint64_t{points_.size()};
+  auto first = std::uint64_t{0};
+  auto total = std::uint64_t{0};
+  EXPECT_OK(MPI_Exscan(&local, &first, 1, MPI_UINT64_T, MPI_SUM,
+                       MPI_COMM_WORLD));
+  EXPECT_OK(MPI_Allreduce(&local, &total, 1, MPI_UINT64_T, MPI_SUM,
+                          MPI_COMM_WORLD));
+
+  // `MPI_Exscan` leaves the receive buffer of rank 0 undefined.
+  first_ = rank_ == 0 ? 0 : first;
+
+  if (total != total_) {
+    throw std::runtime_error("Shards hold " + std::to_string(total) +
+                             " points, header says " + std::to_string(total_));
+  }
+}
+
+// Use of `rand()` here is intentional, see `SeedRandom`.
+auto DistributedSolver::ChooseCentroids() -> void {
+  const auto k = clusters_.size();
+  auto coords = std::vector<double>(2 * k, 0);
+  auto used = std::unordered_set<config::Index>{};
+
+  while (used.size() < k) {
+    auto p = static_cast<config::Index>(std::rand()) % total_;
+    if (used.find(p) != std::end(used)) {
+      continue;
+    }
+
+    if (first_ <= p && p < first_ + points_.size()) {
+      coords[2 * used.size()] = points_[p - first_].x;
+      coords[2 * used.size() + 1] = points_[p - first_].y;
+    }
+    used.insert(p);
+  }
+
+  EXPECT_OK(MPI_Allreduce(MPI_IN_PLACE, coords.data(),
+                          static_cast<int>(coords.size()), MPI_DOUBLE, MPI_SUM,
+                          MPI_COMM_WORLD));
+
+  for (auto c = config::Index{0}; c < k; ++c) {
+    clusters_[c].Centroid().x = coords[2 * c];
+    clusters_[c].Centroid().y = coords[2 * c + 1];
+  }
+}
+
+auto DistributedSolver::ReduceSums() -> void {
+  const auto k = clusters_.size();
+  sums_.resize(3 * k);
+
+  for (auto c = config::Index{0}; c < k; ++c) {
+    auto [sum, weight] = clusters_[c].Pending();
+    sums_[3 * c] = sum.x;
+    sums_[3 * c + 1] = sum.y;
+    sums_[3 * c + 2] = weight;
+  }
+
+  EXPECT_OK(MPI_Allreduce(MPI_IN_PLACE, sums_.data(),
+                          static_cast<int>(sums_.size()), MPI_DOUBLE, MPI_SUM,
+                          MPI_COMM_WORLD));
+
+  for (auto c = config::Index{0}; c < k; ++c) {
+    auto sum = Point{};
+    sum.x = sums_[3 * c];
+    sum.y = sums_[3 * c + 1];
+    clusters_[c].SetPending(sum, sums_[3 * c + 2]);
+  }
+}
+
+auto DistributedSolver::Converge(IEngine& engine, bool moved,
+                                 Convergence& convergence) -> bool {
+  auto stats = engine.LastStats();
+
+  // Counts stay exact in doubles far beyond any dataset size.
+  auto local = std::array<double, 5>{
+      moved ? 1.0 : 0.0, static_cast<double>(stats.computed),
+      static_cast<double>(stats.skipped), static_cast<double>(stats.changed),
+      stats.inertia};
+  auto global = std::array<double, 5>{};
+  auto size = static_cast<int>(local.size());
+
+  if (params_.overlap) {
+    auto request = MPI_Request{};
+    EXPECT_OK(MPI_Iallreduce(local.data(), global.data(), size, MPI_DOUBLE,
+                             MPI_SUM, MPI_COMM_WORLD, &request));
+    engine.Refresh();
+    EXPECT_OK(MPI_Wait(&request, MPI_STATUS_IGNORE));
+  } else {
+    EXPECT_OK(MPI_Allreduce(local.data(), global.data(), size, MPI_DOUBLE,
+                            MPI_SUM, MPI_COMM_WORLD));
+  }
+
+  report_.history.push_back({
+      static_cast<config::Size>(global[1]),
+      static_cast<config::Size>(global[2]),
+      static_cast<config::Size>(global[3]),
+      global[4],
+  });
+  return convergence.Done(report_.history.back(), global[0] != 0);
+}
+
+auto DistributedSolver::ComputeInertia() const -> double {
+  auto inertia = 0.0;
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static) reduction(+:inertia)
+  for (auto p = config::Index{0}; p < points_.size(); ++p) {
+    const auto& centroid = clusters_[points_[p].cluster_index].Centroid();
+    auto dx = points_[p].x - centroid.x;
+    auto dy = points_[p].y - centroid.y;
+    inertia += dx * dx + dy * dy;
+  }
+
+  EXPECT_OK(MPI_Allreduce(MPI_IN_PLACE, &inertia, 1, MPI_DOUBLE, MPI_SUM,
+                          MPI_COMM_WORLD));
+  return inertia;
+}
+
+auto DistributedSolver::Write(const std::string& output) const -> void {
+  auto local = std::vector<config::Index>(points_.size());
+  for (auto p = config::Index{0}; p < points_.size(); ++p) {
+    local[p] = points_[p].cluster_index;
+  }
+
+  auto root = rank_ == 0;
+  auto count = static_cast<int>(local.size());
+  auto counts = std::vector<int>(root ? static_cast<config::Size>(ranks_) : 0);
+  EXPECT_OK(MPI_Gather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, 0,
+                       MPI_COMM_WORLD));
+
+  auto displacements = std::vector<int>(counts.size(), 0);
+  for (auto r = config::Index{1}; r < counts.size(); ++r) {
+    displacements[r] = displacements[r - 1] + counts[r - 1];
+  }
+
+  auto labels = std::vector<config::Index>(root ? total_ : 0);
+  EXPECT_OK(MPI_Gatherv(local.data(), count, MPI_UINT64_T, labels.data(),
+                        counts.data(), displacements.data(), MPI_UINT64_T, 0,
+                        MPI_COMM_WORLD));
+
+  if (!root) {
+    return;
+  }
+
+  auto centroids = std::vector<double>{};
+  for (const auto& c : clusters_) {
+    centroids.push_back(c.Centroid().x);
+    centroids.push_back(c.Centroid().y);
+  }
+
+  WriteResult(output, centroids, 2, labels);
+}
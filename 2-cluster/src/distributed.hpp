@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+#include "convergence.hpp"
+#include "cluster.hpp"
+#include "engine.hpp"
+#include "params.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// k-means over a dataset sharded across MPI ranks. Every rank loads its own
+// contiguous shard and runs the usual threaded engine on it. Per-cluster
+// sums and counts are combined by one `MPI_Allreduce` per iteration, so all
+// ranks compute the same centroids; statistics for stopping rules are
+// agreed on by a second, tiny reduction. With `Params::overlap` the latter is
+// non-blocking and the engine refreshes its bounds for the next iteration
+// while it is in flight. Labels are gathered to rank 0, which writes them.
+// Requires MPI to be initialized, see `WorldGuard`.
+class DistributedSolver {
+ public:
+  explicit DistributedSolver(Params params);
+
+  auto Solve(const std::string& input, const std::string& output) -> void;
+
+  auto LastReport() const -> const Report&;
+
+ private:
+  auto Read(const std::string& input) -> void;
+
+  // Same centroids as the single-process random seeding: every rank draws
+  // the same global indices, their owners contribute coordinates.
+  auto ChooseCentroids() -> void;
+
+  // Replaces per-rank sums and counts of clusters with global ones.
+  auto ReduceSums() -> void;
+
+  // Agrees on whether any centroid has moved, records global statistics
+  // and returns whether `convergence` stops iterating.
+  auto Converge(IEngine& engine, bool moved, Convergence& convergence)
+      -> bool;
+
+  auto ComputeInertia() const -> double;
+
+  auto Write(const std::string& output) const -> void;
+
+ private:
+  Params params_;
+  Report report_;
+
+  int rank_{0};
+  int ranks_{1};
+
+  config::Size total_{0};   // points in all shards
+  config::Index first_{0};  // global index of the first local point
+
+  Points points_;
+  Clusters clusters_;
+  std::vector<double> sums_;  // reduction buffer
+};
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "elkan.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr auto kInf = std::numeric_limits<double>::infinity();
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+ElkanEngine::ElkanEngine(Points& points, Clusters& clusters)
+    : BoundedEngine(points, clusters),
+      upper_(points.size(), kInf),
+      lower_(points.size() * clusters.size(), 0),
+      half_distances_(clusters.size() * clusters.size(), 0),
+      separation_(clusters.size(), 0) {
+}
+
+auto ElkanEngine::Prepare() -> void {
+  const auto k = clusters_.size();
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(runtime)
+  for (auto i = config::Index{0}; i < k; ++i) {
+    auto nearest = kInf;
+
+    for (auto j = config::Index{0}; j < k; ++j) {
+      auto half = std::sqrt(Distance2To(j, clusters_[i].Centroid())) / 2;
+      half_distances_[i * k + j] = half;
+      if (i != j) {
+        nearest = std::min(nearest, half);
+      }
+    }
+
+    separation_[i] = nearest;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto ElkanEngine::AssignAll(config::Index p) -> config::Size {
+  const auto k = clusters_.size();
+  auto* lower = &lower_[p * k];
+
+  auto nearest = config::Index{0};
+  auto min_dist = kInf;
+
+  for (auto c = config::Index{0}; c < k; ++c) {
+    auto dist = Distance2To(c, points_[p]);
+    lower[c] = std::sqrt(dist) + total_drift_[c];
+    if (dist < min_dist) {
+      nearest = c;
+      min_dist = dist;
+    }
+  }
+
+  points_[p].cluster_index = nearest;
+  upper_[p] = std::sqrt(min_dist) - total_drift_[nearest];
+
+  return k;
+}
+
+auto ElkanEngine::AssignPruned(config::Index p) -> config::Size {
+  const auto k = clusters_.size();
+  auto* lower = &lower_[p * k];
+  auto& point = points_[p];
+
+  auto nearest = point.cluster_index;
+  auto bound = upper_[p] + total_drift_[nearest];
+  auto upper = Inflate(bound);
+
+  if (upper < separation_[nearest]) {
+    return 0;
+  }
+
+  // The bound is loose after centroids have moved: tighten it first,
+  // most points are settled by the separation test right after that.
+  auto min_dist = Distance2To(nearest, point);
+  bound = std::sqrt(min_dist);
+  upper = Inflate(bound);
+  lower[nearest] = bound + total_drift_[nearest];
+
+  auto computed = config::Size{1};
+
+  if (upper < separation_[nearest]) {
+    upper_[p] = bound - total_drift_[nearest];
+    return computed;
+  }
+
+  // Both tests are strict: a centroid at exactly the same distance
+  // must still be evaluated for Lloyd's lowest-index tie breaking.
+  auto pruned = [&](config::Index c) {
+    return upper < half_distances_[nearest * k + c] ||
+           upper < lower[c] - total_drift_[c];
+  };
+
+  for (auto c = config::Index{0}; c < k; ++c) {
+    if (c == nearest || pruned(c)) {
+      continue;
+    }
+
+    auto dist = Distance2To(c, point);
+    auto root = std::sqrt(dist);
+    lower[c] = root + total_drift_[c];
+    ++computed;
+
+    if (dist < min_dist || (dist == min_dist && c < nearest)) {
+      nearest = c;
+      min_dist = dist;
+      bound = root;
+      upper = Inflate(bound);
+    }
+  }
+
+  point.cluster_index = nearest;
+  upper_[p] = bound - total_drift_[nearest];
+
+  return computed;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+
+#include "bounded.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Elkan's algorithm: triangle inequality with one upper bound per point,
+// one lower bound per (point, centroid) pair and pairwise centroid distances.
+// Needs O(n * k) memory for the lower bounds.
+//
+// Bounds are stored relative to the total drift of their centroid, so
+// moving centroids costs O(k) instead of touching all n * k lower bounds.
+class ElkanEngine : public BoundedEngine {
+ public:
+  ElkanEngine(Points& points, Clusters& clusters);
+
+ protected:
+  auto Prepare() -> void override;
+
+  auto AssignAll(config::Index p) -> config::Size override;
+  auto AssignPruned(config::Index p) -> config::Size override;
+
+ private:
+  std::vector<double> upper_;           // minus drift of assigned centroid
+  std::vector<double> lower_;           // n rows of k bounds, plus drift
+  std::vector<double> half_distances_;  // k x k, halved centroid distances
+  std::vector<double> separation_;      // half distance to nearest centroid
+};
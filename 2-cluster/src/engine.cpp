@@ -0,0 +1,173 @@
+#include <stdexcept>
+#include <string>
+
+#include "engine.hpp"
+#include "elkan.hpp"
+#include "hamerly.hpp"
+#include "kdtree.hpp"
+#include "lloyd.hpp"
+#include "numa.hpp"
+#include "parallel.hpp"
+#include "yinyang.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto ParseMode(std::string_view name) -> Mode {
+  if (name == "lloyd") {
+    return Mode::kLloyd;
+  }
+  if (name == "elkan") {
+    return Mode::kElkan;
+  }
+  if (name == "hamerly") {
+    return Mode::kHamerly;
+  }
+  if (name == "yinyang") {
+    return Mode::kYinyang;
+  }
+  if (name == "kdtree") {
+    return Mode::kKdTree;
+  }
+  if (name == "gemm") {
+    return Mode::kGemm;
+  }
+  if (name == "dbscan") {
+    return Mode::kDbscan;
+  }
+  if (name == "spherical") {
+    return Mode::kSpherical;
+  }
+  if (name == "bisecting") {
+    return Mode::kBisecting;
+  }
+  throw std::invalid_argument("Unknown engine: " + std::string{name});
+}
+
+auto ToString(Mode mode) -> std::string_view {
+  switch (mode) {
+    case Mode::kLloyd:
+      return "lloyd";
+    case Mode::kElkan:
+      return "elkan";
+    case Mode::kHamerly:
+      return "hamerly";
+    case Mode::kYinyang:
+      return "yinyang";
+    case Mode::kKdTree:
+      return "kdtree";
+    case Mode::kGemm:
+      return "gemm";
+    case Mode::kDbscan:
+      return "dbscan";
+    case Mode::kSpherical:
+      return "spherical";
+    case Mode::kBisecting:
+      return "bisecting";
+  }
+  return "unknown";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto StepStats::SkippedFraction() const -> double {
+  auto total = computed + skipped;
+  return total == 0
+             ? 0.0
+             : static_cast<double>(skipped) / static_cast<double>(total);
+}
+
+auto StepStats::operator+=(const StepStats& other) -> StepStats& {
+  computed += other.computed;
+  skipped += other.skipped;
+  changed += other.changed;
+  inertia += other.inertia;
+  return *this;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto IEngine::Step() -> bool {
+  Assign();
+  return Update();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto MakeEngine(Mode mode, Points& points, Clusters& clusters) -> IEnginePtr {
+  switch (mode) {
+    case Mode::kLloyd:
+      return std::make_unique<LloydEngine>(points, clusters);
+    case Mode::kElkan:
+      return std::make_unique<ElkanEngine>(points, clusters);
+    case Mode::kHamerly:
+      return std::make_unique<HamerlyEngine>(points, clusters);
+    case Mode::kYinyang:
+      return std::make_unique<YinyangEngine>(points, clusters);
+    case Mode::kKdTree:
+      return std::make_unique<KdTreeEngine>(points, clusters);
+    case Mode::kGemm:
+      throw std::invalid_argument("gemm engine runs on dense datasets only");
+    case Mode::kDbscan:
+      throw std::invalid_argument("dbscan is not a k-means engine");
+    case Mode::kSpherical:
+      throw std::invalid_argument(
+          "spherical engine runs on sparse datasets only");
+    case Mode::kBisecting:
+      throw std::invalid_argument("bisecting is not an iterative engine");
+  }
+  throw std::invalid_argument("Unknown engine");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+DomainSums::DomainSums(Clusters& clusters) : clusters_(clusters) {
+  if (numa::Domains() > 1) {
+    domains_.resize(numa::Domains());
+  }
+}
+
+auto DomainSums::Reset() -> void {
+  for (auto& domain : domains_) {
+    domain.resize(clusters_.size());
+  }
+}
+
+auto DomainSums::Local() -> Clusters& {
+  return domains_.empty() ? clusters_ : domains_[numa::ThreadDomain()];
+}
+
+auto DomainSums::Flush() -> void {
+  if (domains_.empty()) {
+    return;
+  }
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto c = config::Index{0}; c < clusters_.size(); ++c) {
+    auto [sum, weight] = clusters_[c].Pending();
+    for (auto& domain : domains_) {
+      auto [part, part_weight] = domain[c].Pending();
+      sum.x += part.x;
+      sum.y += part.y;
+      weight += part_weight;
+      domain[c].SetPending({}, 0);
+    }
+    clusters_[c].SetPending(sum, weight);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto UpdateClusters(Clusters& clusters) -> bool {
+  auto moved = parallel::Reduce<config::Size>(
+      clusters.size(), 1, [&clusters](config::Index first, config::Index last) {
+        auto count = config::Size{0};
+        for (auto c = first; c < last; ++c) {
+          if (clusters[c].Update()) {
+            ++count;
+          }
+        }
+        return count;
+      });
+
+  return moved > 0;
+}
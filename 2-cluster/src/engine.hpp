@@ -0,0 +1,101 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "config.hpp"
+#include "cluster.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+enum class Mode {
+  kLloyd,
+  kElkan,
+  kHamerly,
+  kYinyang,
+  kKdTree,
+  kGemm,       // dense datasets only, see `DenseSolver`
+  kDbscan,     // not k-means, see `DbscanSolver`
+  kSpherical,  // sparse datasets only, see `SparseSolver`
+  kBisecting,  // not iterative, see `BisectingSolver`
+};
+
+auto ParseMode(std::string_view name) -> Mode;
+auto ToString(Mode mode) -> std::string_view;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Measurements of a single iteration, gathered by the assignment pass.
+struct StepStats {
+  // Point-to-centroid distance evaluations.
+  config::Size computed{0};
+  config::Size skipped{0};
+
+  config::Size changed{0};  // points whose `cluster_index` changed
+  double inertia{0};        // against the centroids points were assigned to
+
+  auto SkippedFraction() const -> double;
+
+  auto operator+=(const StepStats& other) -> StepStats&;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Engine owns the assignment strategy, points and clusters are borrowed
+// from `Solver` and must outlive the engine.
+class IEngine {
+ public:
+  virtual ~IEngine() = default;
+
+  // Assigns every point to the nearest centroid and accumulates it
+  // into its cluster.
+  virtual auto Assign() -> void = 0;
+
+  // Recalculates centroids from accumulated points.
+  // Returns whether any centroid has moved.
+  virtual auto Update() -> bool = 0;
+
+  // Brings centroids and bounds kept by the engine up to date with the last
+  // `Update`. `Assign` calls it when needed, calling it earlier lets
+  // a solver overlap it with communication.
+  virtual auto Refresh() -> void = 0;
+
+  virtual auto LastStats() const -> StepStats = 0;
+
+  // Whole iteration: `Assign` and `Update`.
+  auto Step() -> bool;
+};
+
+using IEnginePtr = std::unique_ptr<IEngine>;
+
+auto MakeEngine(Mode mode, Points& points, Clusters& clusters) -> IEnginePtr;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Sums of points per NUMA domain: threads add points to the copy of
+// clusters of their own domain, copies are folded into the clusters once
+// all points are assigned. With a single domain points go straight to them.
+class DomainSums {
+ public:
+  explicit DomainSums(Clusters& clusters);
+
+  // Sizes copies after the number of clusters, call before a parallel pass.
+  auto Reset() -> void;
+
+  // Clusters to add points of the calling thread to.
+  auto Local() -> Clusters&;
+
+  // Adds sums of every domain to pending sums of the clusters.
+  auto Flush() -> void;
+
+ private:
+  Clusters& clusters_;
+  std::vector<Clusters> domains_;  // empty with a single domain
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Recalculates centroids of all clusters from accumulated points.
+// Returns whether any centroid has moved.
+auto UpdateClusters(Clusters& clusters) -> bool;
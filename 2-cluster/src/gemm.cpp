@@ -0,0 +1,398 @@
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#include <immintrin.h>
+
+#include "gemm.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr auto kInf = std::numeric_limits<double>::infinity();
+
+// Blocking: a micro-panel of `kDepthBlock x Width()` centroid coordinates
+// stays in L1 while it is multiplied by every row panel of a point tile,
+// and a packed tile of `kPointTile x kDepthBlock` coordinates stays in L2.
+// Tiles are multiples of every micro-kernel shape below.
+constexpr auto kDepthBlock = config::Size{128};
+constexpr auto kPointTile = config::Size{64};
+constexpr auto kCentroidTile = config::Size{192};
+
+// Arguments of a single micro-kernel call computing a `kRows x kCols` tile
+// of dot products over `depth` dimensions.
+struct Micro {
+  config::Size depth;
+  const double* points;     // packed, `kRows` coordinates per dimension
+  const double* centroids;  // packed, `kCols` coordinates per dimension
+  double* partial;          // `kRows x kCols` dot products over earlier blocks
+  bool first;               // no earlier blocks, `partial` is ignored
+  bool last;                // take the argmin instead of storing `partial`
+
+  // Epilogue: `norms` and index of the first centroid of the tile,
+  // running minima and their labels for the rows of the tile.
+  const double* norms;
+  config::Index base;
+  double* best;
+  config::Index* labels;
+};
+
+// `|x|^2` is the same for every centroid, so only `|c|^2 - 2 x.c` is
+// compared. Lanes are scanned in ascending order with `<`, so ties go to
+// the lowest centroid index like in the other kernels.
+template <config::Size Cols>
+auto ReduceRow(const std::array<double, Cols>& dist, const Micro& m,
+               config::Index row) -> void {
+  for (auto l = config::Size{0}; l < Cols; ++l) {
+    if (dist[l] < m.best[row]) {
+      m.best[row] = dist[l];
+      m.labels[row] = m.base + l;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct ScalarKernel {
+  static constexpr auto kRows = config::Size{4};
+  static constexpr auto kCols = config::Size{4};
+
+  static auto Run(const Micro& m) -> void {
+    double acc[kRows][kCols];
+
+    for (auto r = config::Size{0}; r < kRows; ++r) {
+      for (auto c = config::Size{0}; c < kCols; ++c) {
+        acc[r][c] = m.first ? 0.0 : m.partial[r * kCols + c];
+      }
+    }
+
+    const auto* a = m.points;
+    const auto* b = m.centroids;
+    for (auto d = config::Size{0}; d < m.depth; ++d, a += kRows, b += kCols) {
+      for (auto r = config::Size{0}; r < kRows; ++r) {
+        for (auto c = config::Size{0}; c < kCols; ++c) {
+          acc[r][c] += a[r] * b[c];
+        }
+      }
+    }
+
+    for (auto r = config::Size{0}; r < kRows; ++r) {
+      if (!m.last) {
+        std::copy_n(acc[r], kCols, m.partial + r * kCols);
+        continue;
+      }
+
+      auto dist = std::array<double, kCols>{};
+      for (auto c = config::Size{0}; c < kCols; ++c) {
+        dist[c] = m.norms[c] - 2 * acc[r][c];
+      }
+      ReduceRow(dist, m, r);
+    }
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct Avx2Kernel {
+  static constexpr auto kRows = config::Size{4};
+  static constexpr auto kCols = config::Size{12};
+
+  __attribute__((target("avx2,fma"))) static auto Run(const Micro& m)
+      -> void {
+    constexpr auto kVectors = kCols / 4;
+
+    __m256d acc[kRows][kVectors];
+
+    for (auto r = config::Size{0}; r < kRows; ++r) {
+      for (auto v = config::Size{0}; v < kVectors; ++v) {
+        acc[r][v] = m.first ? _mm256_setzero_pd()
+                            : _mm256_loadu_pd(m.partial + r * kCols + v * 4);
+      }
+    }
+
+    const auto* a = m.points;
+    const auto* b = m.centroids;
+    for (auto d = config::Size{0}; d < m.depth; ++d, a += kRows, b += kCols) {
+      __m256d col[kVectors];
+      for (auto v = config::Size{0}; v < kVectors; ++v) {
+        col[v] = _mm256_loadu_pd(b + v * 4);
+      }
+
+      for (auto r = config::Size{0}; r < kRows; ++r) {
+        const auto row = _mm256_broadcast_sd(a + r);
+        for (auto v = config::Size{0}; v < kVectors; ++v) {
+          acc[r][v] = _mm256_fmadd_pd(row, col[v], acc[r][v]);
+        }
+      }
+    }
+
+    const auto minus_two = _mm256_set1_pd(-2);
+
+    for (auto r = config::Size{0}; r < kRows; ++r) {
+      if (!m.last) {
+        for (auto v = config::Size{0}; v < kVectors; ++v) {
+          _mm256_storeu_pd(m.partial + r * kCols + v * 4, acc[r][v]);
+        }
+        continue;
+      }
+
+      auto dist = std::array<double, kCols>{};
+      const auto best = _mm256_set1_pd(m.best[r]);
+      auto closer = 0;
+      for (auto v = config::Size{0}; v < kVectors; ++v) {
+        const auto norms = _mm256_loadu_pd(m.norms + v * 4);
+        const auto lane = _mm256_fmadd_pd(minus_two, acc[r][v], norms);
+        _mm256_storeu_pd(dist.data() + v * 4, lane);
+        closer |= _mm256_movemask_pd(_mm256_cmp_pd(lane, best, _CMP_LT_OQ));
+      }
+
+      if (closer != 0) {
+        ReduceRow(dist, m, r);
+      }
+    }
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct Avx512Kernel {
+  static constexpr auto kRows = config::Size{8};
+  static constexpr auto kCols = config::Size{24};
+
+  __attribute__((target("avx512f"))) static auto Run(const Micro& m) -> void {
+    constexpr auto kVectors = kCols / 8;
+
+    __m512d acc[kRows][kVectors];
+
+    for (auto r = config::Size{0}; r < kRows; ++r) {
+      for (auto v = config::Size{0}; v < kVectors; ++v) {
+        acc[r][v] = m.first ? _mm512_setzero_pd()
+                            : _mm512_loadu_pd(m.partial + r * kCols + v * 8);
+      }
+    }
+
+    const auto* a = m.points;
+    const auto* b = m.centroids;
+    for (auto d = config::Size{0}; d < m.depth; ++d, a += kRows, b += kCols) {
+      __m512d col[kVectors];
+      for (auto v = config::Size{0}; v < kVectors; ++v) {
+        col[v] = _mm512_loadu_pd(b + v * 8);
+      }
+
+      for (auto r = config::Size{0}; r < kRows; ++r) {
+        const auto row = _mm512_set1_pd(a[r]);
+        for (auto v = config::Size{0}; v < kVectors; ++v) {
+          acc[r][v] = _mm512_fmadd_pd(row, col[v], acc[r][v]);
+        }
+      }
+    }
+
+    const auto minus_two = _mm512_set1_pd(-2);
+
+    for (auto r = config::Size{0}; r < kRows; ++r) {
+      if (!m.last) {
+        for (auto v = config::Size{0}; v < kVectors; ++v) {
+          _mm512_storeu_pd(m.partial + r * kCols + v * 8, acc[r][v]);
+        }
+        continue;
+      }
+
+      auto dist = std::array<double, kCols>{};
+      const auto best = _mm512_set1_pd(m.best[r]);
+      auto closer = __mmask8{0};
+      for (auto v = config::Size{0}; v < kVectors; ++v) {
+        const auto norms = _mm512_loadu_pd(m.norms + v * 8);
+        const auto lane = _mm512_fmadd_pd(minus_two, acc[r][v], norms);
+        _mm512_storeu_pd(dist.data() + v * 8, lane);
+        closer |= _mm512_cmp_pd_mask(lane, best, _CMP_LT_OQ);
+      }
+
+      // Most tiles hold no closer centroid, skip the scalar scan for them.
+      if (closer != 0) {
+        ReduceRow(dist, m, r);
+      }
+    }
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct Scratch {
+  std::vector<double> points;   // packed point tile
+  std::vector<double> partial;  // dot products of a tile over earlier blocks
+  std::vector<double> best;
+  std::vector<config::Index> labels;
+};
+
+// Assigns up to `kPointTile` points.
+template <typename Kernel>
+auto AssignTile(const GemmCentroids& centroids, const double* rows,
+                config::Size count, config::Index* labels, Scratch& scratch)
+    -> void {
+  constexpr auto kRows = Kernel::kRows;
+  constexpr auto kCols = Kernel::kCols;
+
+  const auto dim = centroids.Dim();
+  const auto padded = centroids.PaddedCount();
+  const auto row_panels = (count + kRows - 1) / kRows;
+  const auto height = row_panels * kRows;
+
+  // Packed once for all centroid tiles: block after block of
+  // `kDepthBlock` dimensions, row panel after row panel within a block.
+  scratch.points.resize(height * dim);
+  for (auto pc = config::Index{0}; pc < dim; pc += kDepthBlock) {
+    auto kc = std::min(kDepthBlock, dim - pc);
+    auto* block = scratch.points.data() + pc * height;
+
+    for (auto i = config::Index{0}; i < row_panels; ++i) {
+      for (auto d = config::Index{0}; d < kc; ++d) {
+        for (auto r = config::Index{0}; r < kRows; ++r) {
+          auto p = i * kRows + r;
+          block[(i * kc + d) * kRows + r] =
+              p < count ? rows[p * dim + pc + d] : 0.0;
+        }
+      }
+    }
+  }
+
+  scratch.partial.resize(height * kCentroidTile);
+  scratch.best.assign(height, kInf);
+  scratch.labels.assign(height, 0);
+
+  for (auto jc = config::Index{0}; jc < padded; jc += kCentroidTile) {
+    auto col_panels = std::min(kCentroidTile, padded - jc) / kCols;
+
+    for (auto pc = config::Index{0}; pc < dim; pc += kDepthBlock) {
+      auto kc = std::min(kDepthBlock, dim - pc);
+      const auto* block = scratch.points.data() + pc * height;
+
+      for (auto j = config::Index{0}; j < col_panels; ++j) {
+        auto base = jc + j * kCols;
+
+        for (auto i = config::Index{0}; i < row_panels; ++i) {
+          auto tile = (i * col_panels + j) * kRows * kCols;
+          Kernel::Run({
+              .depth = kc,
+              .points = block + i * kc * kRows,
+              .centroids = centroids.panels.data() + (base * dim + pc * kCols),
+              .partial = scratch.partial.data() + tile,
+              .first = pc == 0,
+              .last = pc + kc == dim,
+              .norms = centroids.norms.data() + base,
+              .base = base,
+              .best = scratch.best.data() + i * kRows,
+              .labels = scratch.labels.data() + i * kRows,
+          });
+        }
+      }
+    }
+  }
+
+  std::copy_n(scratch.labels.begin(), count, labels);
+}
+
+template <typename Kernel>
+auto AssignAll(const GemmCentroids& centroids, const double* rows,
+               config::Size count, config::Index* labels) -> void {
+  thread_local auto scratch = Scratch{};
+
+  const auto dim = centroids.Dim();
+  for (auto p = config::Index{0}; p < count; p += kPointTile) {
+    AssignTile<Kernel>(centroids, rows + p * dim,
+                       std::min(kPointTile, count - p), labels + p, scratch);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+using AssignFn = void (*)(const GemmCentroids&, const double*, config::Size,
+                          config::Index*);
+
+struct Dispatch {
+  AssignFn assign;
+  config::Size width;
+  std::string_view isa;
+};
+
+template <typename Kernel>
+auto Make(std::string_view isa) -> Dispatch {
+  return {AssignAll<Kernel>, Kernel::kCols, isa};
+}
+
+auto Select() -> Dispatch {
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx512f")) {
+    return Make<Avx512Kernel>("avx512");
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return Make<Avx2Kernel>("avx2");
+  }
+  return Make<ScalarKernel>("scalar");
+}
+
+auto Selected() -> const Dispatch& {
+  static const auto dispatch = Select();
+  return dispatch;
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto GemmCentroids::Load(const std::vector<double>& centroids,
+                         config::Size dim) -> void {
+  dim_ = dim;
+  count_ = centroids.size() / dim;
+
+  const auto width = Width();
+  const auto padded = (count_ + width - 1) / width * width;
+
+  panels.assign(padded * dim_, 0);
+  norms.assign(padded, kInf);
+
+  for (auto c = config::Index{0}; c < count_; ++c) {
+    auto* panel = panels.data() + (c / width) * width * dim_;
+    auto norm = 0.0;
+
+    for (auto d = config::Index{0}; d < dim_; ++d) {
+      auto x = centroids[c * dim_ + d];
+      panel[d * width + c % width] = x;
+      norm += x * x;
+    }
+
+    norms[c] = norm;
+  }
+}
+
+auto GemmCentroids::Count() const -> config::Size {
+  return count_;
+}
+
+auto GemmCentroids::PaddedCount() const -> config::Size {
+  return norms.size();
+}
+
+auto GemmCentroids::Dim() const -> config::Size {
+  return dim_;
+}
+
+auto GemmCentroids::Width() const -> config::Size {
+  return Selected().width;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace kernels {
+
+auto AssignNearestGemm(const GemmCentroids& centroids, const double* rows,
+                       config::Size count, config::Index* labels) -> void {
+  Selected().assign(centroids, rows, count, labels);
+}
+
+auto GemmIsa() -> std::string_view {
+  return Selected().isa;
+}
+
+}  // namespace kernels
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "config.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Centroids of any dimension packed for the GEMM kernel: panels of
+// `Width()` centroids, each stored dimension by dimension, so the
+// micro-kernel streams a panel with contiguous vector loads.
+// Panels are padded with zero centroids of infinite norm.
+struct GemmCentroids {
+ public:
+  // Takes `centroids` row-major, `dim` coordinates per centroid.
+  auto Load(const std::vector<double>& centroids, config::Size dim) -> void;
+
+  auto Count() const -> config::Size;
+  auto PaddedCount() const -> config::Size;
+  auto Dim() const -> config::Size;
+  auto Width() const -> config::Size;
+
+ public:
+  std::vector<double> panels;
+  std::vector<double> norms;  // squared, `PaddedCount()` of them
+
+ private:
+  config::Size count_{0};
+  config::Size dim_{0};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace kernels {
+
+// Same contract as `AssignNearest` over rows, computed as
+// `|x|^2 - 2 x.c + |c|^2` by a cache-blocked, register-tiled matrix multiply.
+// The argmin is taken in the micro-kernel epilogue, so no more than a tile
+// of the `count x k` distance matrix ever exists. Distances are rounded
+// differently from the direct formula, so near-ties may resolve differently.
+auto AssignNearestGemm(const GemmCentroids& centroids, const double* rows,
+                       config::Size count, config::Index* labels) -> void;
+
+// Micro-kernel chosen by runtime dispatch: "avx512", "avx2" or "scalar".
+auto GemmIsa() -> std::string_view;
+
+}  // namespace kernels
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "hamerly.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr auto kInf = std::numeric_limits<double>::infinity();
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+HamerlyEngine::HamerlyEngine(Points& points, Clusters& clusters)
+    : BoundedEngine(points, clusters),
+      upper_(points.size(), kInf),
+      lower_(points.size(), 0) {
+}
+
+auto HamerlyEngine::Prepare() -> void {
+  ComputeSeparation(centroids_, separation_);
+
+  max_drift_index_ = 0;
+  max_drift_ = 0;
+  second_drift_ = 0;
+
+  for (auto c = config::Index{0}; c < drift_.size(); ++c) {
+    if (drift_[c] > max_drift_) {
+      second_drift_ = max_drift_;
+      max_drift_ = drift_[c];
+      max_drift_index_ = c;
+    } else if (drift_[c] > second_drift_) {
+      second_drift_ = drift_[c];
+    }
+  }
+}
+
+auto HamerlyEngine::AssignAll(config::Index p) -> config::Size {
+  return Scan(p, clusters_.size(), kInf);
+}
+
+auto HamerlyEngine::AssignPruned(config::Index p) -> config::Size {
+  auto nearest = points_[p].cluster_index;
+
+  upper_[p] += drift_[nearest];
+  lower_[p] -= nearest == max_drift_index_ ? second_drift_ : max_drift_;
+
+  auto bound = std::max(separation_[nearest], lower_[p]);
+  if (Inflate(upper_[p]) < bound) {
+    return 0;
+  }
+
+  auto dist = Distance2To(nearest, points_[p]);
+  upper_[p] = std::sqrt(dist);
+  if (Inflate(upper_[p]) < bound) {
+    return 1;
+  }
+
+  return Scan(p, nearest, dist);
+}
+
+auto HamerlyEngine::Scan(config::Index p, config::Index known,
+                         double known_dist) -> config::Size {
+  const auto k = clusters_.size();
+  auto& point = points_[p];
+
+  auto nearest = known < k ? known : 0;
+  auto min_dist = known_dist;
+  auto second_dist = kInf;
+
+  for (auto c = config::Index{0}; c < k; ++c) {
+    if (c == known) {
+      continue;
+    }
+
+    auto dist = Distance2To(c, point);
+    if (dist < min_dist || (dist == min_dist && c < nearest)) {
+      second_dist = min_dist;
+      nearest = c;
+      min_dist = dist;
+    } else if (dist < second_dist) {
+      second_dist = dist;
+    }
+  }
+
+  point.cluster_index = nearest;
+  upper_[p] = std::sqrt(min_dist);
+  lower_[p] = std::sqrt(second_dist);
+
+  return k;
+}
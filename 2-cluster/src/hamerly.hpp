@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+#include "bounded.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Hamerly's algorithm: one upper bound and a single lower bound (distance to
+// the second nearest centroid) per point. O(n + k^2) memory, which makes it
+// the choice for large k where Elkan's n * k bounds do not fit.
+class HamerlyEngine : public BoundedEngine {
+ public:
+  HamerlyEngine(Points& points, Clusters& clusters);
+
+ protected:
+  auto Prepare() -> void override;
+
+  auto AssignAll(config::Index p) -> config::Size override;
+  auto AssignPruned(config::Index p) -> config::Size override;
+
+ private:
+  // Scans all centroids but `known`, whose squared distance is `known_dist`.
+  auto Scan(config::Index p, config::Index known, double known_dist)
+      -> config::Size;
+
+ private:
+  std::vector<double> upper_;
+  std::vector<double> lower_;
+  std::vector<double> separation_;
+
+  // Largest and second largest drift, lower bounds move by the largest
+  // drift among centroids other than the assigned one.
+  config::Index max_drift_index_{0};
+  double max_drift_{0};
+  double second_drift_{0};
+};
@@ -0,0 +1,562 @@
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "io.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+auto IsSpace(char c) -> bool {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+auto SkipSpaces(const char* first, const char* last) -> const char* {
+  while (first != last && IsSpace(*first)) {
+    ++first;
+  }
+  return first;
+}
+
+template <typename T>
+auto Parse(const char*& first, const char* last, T& value) -> bool {
+  first = SkipSpaces(first, last);
+  auto [ptr, ec] = std::from_chars(first, last, value);
+  first = ptr;
+  return ec == std::errc{};
+}
+
+// Lines holding anything but whitespace, a point per line.
+auto CountPoints(const char* first, const char* last) -> config::Size {
+  auto count = config::Size{0};
+  auto blank = true;
+
+  for (; first != last; ++first) {
+    if (*first == '\n') {
+      count += blank ? 0 : 1;
+      blank = true;
+    } else if (!IsSpace(*first)) {
+      blank = false;
+    }
+  }
+
+  return count + (blank ? 0 : 1);
+}
+
+auto IsBinary(std::string_view data) -> bool {
+  auto magic = std::uint64_t{0};
+  if (data.size() >= sizeof(BinaryHeader)) {
+    std::memcpy(&magic, data.data(), sizeof(magic));
+  }
+  return magic == BinaryHeader::kMagic;
+}
+
+// Parses the header line, `body` is set to the end of it.
+auto ParseTextHeader(std::string_view text, const char*& body)
+    -> DatasetHeader {
+  const auto* first = text.data();
+  const auto* last = text.data() + text.size();
+
+  auto header = DatasetHeader{};
+  if (!Parse(first, last, header.point_count) ||
+      !Parse(first, last, header.cluster_count)) {
+    throw std::runtime_error("Malformed dataset header");
+  }
+
+  body = std::find(first, last, '\n');
+  auto has_dimension = SkipSpaces(first, body) != body;
+  if (has_dimension &&
+      (!Parse(first, body, header.dimension) || header.dimension == 0)) {
+    throw std::runtime_error("Malformed dataset header");
+  }
+
+  // Sparse datasets follow the dimension by `csr`.
+  first = SkipSpaces(first, body);
+  header.sparse = std::string_view{first, body}.starts_with("csr");
+
+  return header;
+}
+
+auto ParseBinaryHeader(std::string_view data) -> DatasetHeader {
+  auto binary = BinaryHeader{};
+  std::memcpy(&binary, data.data(), sizeof(binary));
+
+  auto header = DatasetHeader{binary.point_count, binary.cluster_count,
+                              binary.dimension};
+  auto coords = header.point_count * header.dimension;
+  if (header.dimension == 0 ||
+      data.size() < sizeof(binary) + coords * sizeof(double)) {
+    throw std::runtime_error("Malformed binary dataset");
+  }
+
+  return header;
+}
+
+// Splits `[first, last)` into `parts` ranges, range `r` is
+// `[bounds[r], bounds[r + 1])`. Every bound but the first and the last one
+// is moved to the end of a line.
+auto SplitLines(const char* first, const char* last, config::Size parts)
+    -> std::vector<const char*> {
+  auto bounds = std::vector<const char*>(parts + 1, last);
+  auto length = static_cast<config::Size>(last - first);
+  for (auto r = config::Index{0}; r < parts; ++r) {
+    const auto* bound = first + r * length / parts;
+    bounds[r] = r == 0 ? first : std::find(bound, last, '\n');
+  }
+  return bounds;
+}
+
+// Parses `dim` coordinates of every point in `[first, last)` in parallel.
+// `resize(count)` is called once the number of points is known,
+// then `store(p, d, value)` puts coordinate `d` of point `p` in place.
+// Returns the number of points.
+template <typename Resize, typename Store>
+auto ParseBody(const char* first, const char* last, config::Size dim,
+               Resize resize, Store store) -> config::Size {
+  const auto ranges = static_cast<config::Size>(config::ThreadCount());
+  const auto bounds = SplitLines(first, last, ranges);
+
+  auto offsets = std::vector<config::Size>(ranges + 1, 0);
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto r = config::Index{0}; r < ranges; ++r) {
+    offsets[r + 1] = CountPoints(bounds[r], bounds[r + 1]);
+  }
+
+  for (auto r = config::Index{0}; r < ranges; ++r) {
+    offsets[r + 1] += offsets[r];
+  }
+
+  resize(offsets[ranges]);
+
+  auto malformed = false;
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static) reduction(||:malformed)
+  for (auto r = config::Index{0}; r < ranges; ++r) {
+    const auto* it = bounds[r];
+    for (auto p = offsets[r]; p < offsets[r + 1]; ++p) {
+      for (auto d = config::Index{0}; d < dim; ++d) {
+        auto value = 0.0;
+        malformed = malformed || !Parse(it, bounds[r + 1], value);
+        store(p, d, value);
+      }
+    }
+  }
+
+  if (malformed) {
+    throw std::runtime_error("Malformed point in dataset");
+  }
+
+  return offsets[ranges];
+}
+
+// Parses 2D points of `[first, last)` into `points`.
+auto ParsePoints(const char* first, const char* last, Points& points)
+    -> config::Size {
+  return ParseBody(
+      first, last, 2,
+      [&points](config::Size count) {
+        points.resize(count);
+      },
+      [&points](config::Index p, config::Index d, double v) {
+        (d == 0 ? points[p].x : points[p].y) = v;
+      });
+}
+
+auto CheckCount(const DatasetHeader& header, config::Size count) -> void {
+  if (count != header.point_count) {
+    throw std::runtime_error("Dataset has " + std::to_string(count) +
+                             " points, header says " +
+                             std::to_string(header.point_count));
+  }
+}
+
+// Coordinates are read in place: the mapping is page aligned and the header
+// keeps them aligned.
+auto BinaryCoords(std::string_view data) -> const double* {
+  return reinterpret_cast<const double*>(  // NOLINT
+      data.data() + sizeof(BinaryHeader));
+}
+
+// `Point` is padded for atomic accumulation, so binary coordinates
+// still have to be spread into `points`.
+auto SpreadPoints(const double* coords, config::Size count, Points& points)
+    -> void {
+  points.resize(count);
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto p = config::Index{0}; p < count; ++p) {
+    points[p].x = coords[2 * p];
+    points[p].y = coords[2 * p + 1];
+  }
+}
+
+auto Validate(const DatasetHeader& header, const std::string& input) -> void {
+  if (header.point_count == 0 || header.cluster_count == 0) {
+    throw std::runtime_error("Empty dataset " + input);
+  }
+}
+
+// Enough for any `double` in `%g` format and any `std::size_t`.
+constexpr auto kMaxNumber = 32;
+
+auto Append(std::string& out, double value) -> void {
+  char buffer[kMaxNumber];
+  auto [ptr, ec] = std::to_chars(std::begin(buffer), std::end(buffer), value,
+                                 std::chars_format::general, 6);
+  out.append(std::begin(buffer), ptr);
+}
+
+auto Append(std::string& out, config::Index value) -> void {
+  char buffer[kMaxNumber];
+  auto [ptr, ec] = std::to_chars(std::begin(buffer), std::end(buffer), value);
+  out.append(std::begin(buffer), ptr);
+}
+
+// Formats `label(p)` of `count` points in parallel and writes them after
+// `head`.
+template <typename Label>
+auto WriteLabels(const std::string& output, std::string head,
+                 config::Size count, Label label) -> void {
+  const auto ranges = static_cast<config::Size>(config::ThreadCount());
+  auto chunks = std::vector<std::string>{};
+  chunks.reserve(ranges + 1);
+  chunks.push_back(std::move(head));
+  chunks.resize(ranges + 1);
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto r = config::Index{0}; r < ranges; ++r) {
+    auto first = r * count / ranges;
+    auto last = (r + 1) * count / ranges;
+
+    auto& chunk = chunks[r + 1];
+    chunk.reserve((last - first) * 4);
+
+    for (auto p = first; p < last; ++p) {
+      Append(chunk, label(p));
+      chunk += '\n';
+    }
+  }
+
+  auto out = std::ofstream{output, std::ios::binary};
+  for (const auto& chunk : chunks) {
+    out.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+  }
+}
+
+auto WriteBinary(const std::string& output, const DatasetHeader& header,
+                 const double* coords) -> void {
+  auto binary = BinaryHeader{};
+  binary.point_count = header.point_count;
+  binary.cluster_count = header.cluster_count;
+  binary.dimension = header.dimension;
+
+  auto size = header.point_count * header.dimension * sizeof(double);
+
+  auto out = std::ofstream{output, std::ios::binary};
+  // NOLINTNEXTLINE
+  out.write(reinterpret_cast<const char*>(&binary), sizeof(binary));
+  // NOLINTNEXTLINE
+  out.write(reinterpret_cast<const char*>(coords),
+            static_cast<std::streamsize>(size));
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+MappedFile::MappedFile(const std::string& path) {
+  auto fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot open " + path);
+  }
+
+  struct stat st {};
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw std::runtime_error("Cannot stat " + path);
+  }
+
+  size_ = static_cast<std::size_t>(st.st_size);
+  if (size_ > 0) {
+    auto* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      ::close(fd);
+      throw std::runtime_error("Cannot map " + path);
+    }
+    ::madvise(data, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(data);
+  }
+
+  ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    ::munmap(const_cast<char*>(data_), size_);  // NOLINT
+  }
+}
+
+auto MappedFile::View() const -> std::string_view {
+  return {data_, size_};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+DenseDataset::DenseDataset(DatasetHeader header, std::vector<double> coords)
+    : header_(header), storage_(std::move(coords)), coords_(storage_.data()) {
+}
+
+DenseDataset::DenseDataset(DatasetHeader header,
+                           std::shared_ptr<const MappedFile> file,
+                           const double* coords)
+    : header_(header), file_(std::move(file)), coords_(coords) {
+}
+
+auto DenseDataset::Header() const -> const DatasetHeader& {
+  return header_;
+}
+
+auto DenseDataset::Coords() const -> const double* {
+  return coords_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto ReadHeader(const std::string& input) -> DatasetHeader {
+  auto file = MappedFile{input};
+  auto data = file.View();
+
+  const auto* body = data.data();
+  auto header = IsBinary(data) ? ParseBinaryHeader(data)
+                               : ParseTextHeader(data, body);
+
+  Validate(header, input);
+  return header;
+}
+
+auto ReadDataset(const std::string& input, Points& points) -> config::Size {
+  auto file = MappedFile{input};
+  auto data = file.View();
+
+  auto header = DatasetHeader{};
+
+  if (IsBinary(data)) {
+    header = ParseBinaryHeader(data);
+    if (header.dimension == 2) {
+      SpreadPoints(BinaryCoords(data), header.point_count, points);
+    }
+  } else {
+    const auto* body = data.data();
+    header = ParseTextHeader(data, body);
+    if (header.dimension == 2 && !header.sparse) {
+      const auto* last = data.data() + data.size();
+      CheckCount(header, ParsePoints(body, last, points));
+    }
+  }
+
+  if (header.dimension != 2 || header.sparse) {
+    throw std::runtime_error("Expected 2D points in " + input);
+  }
+
+  Validate(header, input);
+  return header.cluster_count;
+}
+
+auto ReadShard(const std::string& input, config::Index shard,
+               config::Size shards, Points& points) -> DatasetHeader {
+  auto file = MappedFile{input};
+  auto data = file.View();
+
+  auto header = DatasetHeader{};
+
+  if (IsBinary(data)) {
+    header = ParseBinaryHeader(data);
+    if (header.dimension == 2) {
+      auto first = shard * header.point_count / shards;
+      auto last = (shard + 1) * header.point_count / shards;
+      SpreadPoints(BinaryCoords(data) + 2 * first, last - first, points);
+    }
+  } else {
+    const auto* body = data.data();
+    header = ParseTextHeader(data, body);
+    if (header.dimension == 2 && !header.sparse) {
+      auto bounds = SplitLines(body, data.data() + data.size(), shards);
+      ParsePoints(bounds[shard], bounds[shard + 1], points);
+    }
+  }
+
+  if (header.dimension != 2 || header.sparse) {
+    throw std::runtime_error("Expected 2D points in " + input);
+  }
+
+  Validate(header, input);
+  return header;
+}
+
+auto ReadSparse(const std::string& input) -> SparseDataset {
+  auto file = MappedFile{input};
+  auto data = file.View();
+
+  const auto* body = data.data();
+  auto header = IsBinary(data) ? DatasetHeader{} : ParseTextHeader(data, body);
+  if (!header.sparse) {
+    throw std::runtime_error("Expected a sparse dataset in " + input);
+  }
+  Validate(header, input);
+
+  const auto ranges = static_cast<config::Size>(config::ThreadCount());
+  const auto bounds = SplitLines(body, data.data() + data.size(), ranges);
+
+  // Rows and nonzeros before every range, `column:value` pairs being
+  // counted by their colons.
+  auto row_offsets = std::vector<config::Size>(ranges + 1, 0);
+  auto nonzero_offsets = std::vector<config::Size>(ranges + 1, 0);
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto r = config::Index{0}; r < ranges; ++r) {
+    row_offsets[r + 1] = CountPoints(bounds[r], bounds[r + 1]);
+    nonzero_offsets[r + 1] = static_cast<config::Size>(
+        std::count(bounds[r], bounds[r + 1], ':'));
+  }
+
+  for (auto r = config::Index{0}; r < ranges; ++r) {
+    row_offsets[r + 1] += row_offsets[r];
+    nonzero_offsets[r + 1] += nonzero_offsets[r];
+  }
+  CheckCount(header, row_offsets[ranges]);
+
+  auto result = SparseDataset{};
+  result.header = header;
+  result.row_starts.resize(header.point_count + 1);
+  result.columns.resize(nonzero_offsets[ranges]);
+  result.values.resize(nonzero_offsets[ranges]);
+  result.row_starts[header.point_count] = nonzero_offsets[ranges];
+
+  auto malformed = false;
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static) reduction(||:malformed)
+  for (auto r = config::Index{0}; r < ranges; ++r) {
+    const auto* it = bounds[r];
+    auto row = row_offsets[r];
+    auto i = nonzero_offsets[r];
+
+    while (row < row_offsets[r + 1] && !malformed) {
+      const auto* eol = std::find(it, bounds[r + 1], '\n');
+      it = SkipSpaces(it, eol);
+      if (it == eol) {
+        it = eol + 1;  // blank line
+        continue;
+      }
+
+      result.row_starts[row++] = i;
+      while (it != eol && !malformed) {
+        auto column = std::uint32_t{0};
+        malformed = !Parse(it, eol, column) || column >= header.dimension ||
+                    it == eol || *it++ != ':' ||
+                    !Parse(it, eol, result.values[i]);
+        result.columns[i++] = column;
+        it = SkipSpaces(it, eol);
+      }
+      it = eol == bounds[r + 1] ? eol : eol + 1;
+    }
+  }
+
+  if (malformed) {
+    throw std::runtime_error("Malformed row in dataset " + input);
+  }
+
+  return result;
+}
+
+auto ReadDense(const std::string& input) -> DenseDataset {
+  auto file = std::make_shared<const MappedFile>(input);
+  auto data = file->View();
+
+  if (IsBinary(data)) {
+    auto header = ParseBinaryHeader(data);
+    Validate(header, input);
+    return {header, std::move(file), BinaryCoords(data)};
+  }
+
+  const auto* body = data.data();
+  auto header = ParseTextHeader(data, body);
+  if (header.sparse) {
+    throw std::runtime_error("Expected dense points in " + input);
+  }
+
+  auto coords = std::vector<double>{};
+  auto dim = header.dimension;
+
+  auto count = ParseBody(
+      body, data.data() + data.size(), dim,
+      [&coords, dim](config::Size size) {
+        coords.resize(size * dim);
+      },
+      [&coords, dim](config::Index p, config::Index d, double v) {
+        coords[p * dim + d] = v;
+      });
+  CheckCount(header, count);
+
+  Validate(header, input);
+  return {header, std::move(coords)};
+}
+
+auto WriteBinary(const std::string& output, const Points& points,
+                 config::Size cluster_count) -> void {
+  auto coords = std::vector<double>{};
+  coords.reserve(2 * points.size());
+  for (const auto& p : points) {
+    coords.push_back(p.x);
+    coords.push_back(p.y);
+  }
+
+  WriteBinary(output, {points.size(), cluster_count, 2}, coords.data());
+}
+
+auto WriteBinary(const std::string& output, const DenseDataset& data) -> void {
+  WriteBinary(output, data.Header(), data.Coords());
+}
+
+auto WriteResult(const std::string& output, const Clusters& clusters,
+                 const Points& points) -> void {
+  auto head = std::string{};
+  for (const auto& c : clusters) {
+    Append(head, c.Centroid().x);
+    head += ' ';
+    Append(head, c.Centroid().y);
+    head += '\n';
+  }
+
+  WriteLabels(output, std::move(head), points.size(), [&](config::Index p) {
+    return points[p].cluster_index;
+  });
+}
+
+auto WriteResult(const std::string& output,
+                 const std::vector<double>& centroids, config::Size dim,
+                 const std::vector<config::Index>& labels) -> void {
+  auto head = std::string{};
+  for (auto c = config::Index{0}; c < centroids.size(); c += dim) {
+    for (auto d = config::Index{0}; d < dim; ++d) {
+      Append(head, centroids[c + d]);
+      head += d + 1 == dim ? '\n' : ' ';
+    }
+  }
+
+  WriteLabels(output, std::move(head), labels.size(), [&](config::Index p) {
+    return labels[p];
+  });
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "config.hpp"
+#include "cluster.hpp"
+#include "dataset.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  auto operator=(const MappedFile&) -> MappedFile& = delete;
+
+  auto View() const -> std::string_view;
+
+ private:
+  const char* data_{nullptr};
+  std::size_t size_{0};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Binary dataset: this header followed by `point_count * dimension` native
+// doubles, one point after another. The header keeps coordinates 8-byte
+// aligned within the (page aligned) mapping.
+struct BinaryHeader {
+  static constexpr auto kMagic = std::uint64_t{0x314E49424E41454DULL};
+
+  std::uint64_t magic{kMagic};  // "MEANBIN1"
+  std::uint64_t point_count{0};
+  std::uint64_t cluster_count{0};
+  std::uint64_t dimension{2};
+};
+
+// Text and binary datasets are told apart by magic. Text header is `n k`
+// for 2D points or `n k d` for any dimension, followed by a point per line.
+auto ReadHeader(const std::string& input) -> DatasetHeader;
+
+// Loads points of a 2D dataset. Text is parsed in parallel with
+// `std::from_chars` on ranges split at line boundaries; binary coordinates
+// are read straight from the mapping.
+// Returns the number of clusters requested by the dataset.
+auto ReadDataset(const std::string& input, Points& points) -> config::Size;
+
+// Loads shard `shard` out of `shards` contiguous shards of a 2D dataset:
+// binary datasets are split by points, text ones by bytes at line
+// boundaries. Returns the header of the whole dataset.
+auto ReadShard(const std::string& input, config::Index shard,
+               config::Size shards, Points& points) -> DatasetHeader;
+
+// Loads a sparse text dataset: header `n k d csr`, then a row per line of
+// space-separated `column:value` pairs with 0-based columns below `d`.
+// Rows are counted and parsed in parallel on ranges split at line
+// boundaries, like dense ones; blank lines are skipped.
+auto ReadSparse(const std::string& input) -> SparseDataset;
+
+// Loads a dataset of any dimension. Binary coordinates are not copied at all,
+// the dataset keeps the file mapped instead.
+auto ReadDense(const std::string& input) -> DenseDataset;
+
+auto WriteBinary(const std::string& output, const Points& points,
+                 config::Size cluster_count) -> void;
+auto WriteBinary(const std::string& output, const DenseDataset& data) -> void;
+
+// Writes centroids and labels in the text format of `results/`,
+// formatting ranges of labels in parallel with `std::to_chars`.
+auto WriteResult(const std::string& output, const Clusters& clusters,
+                 const Points& points) -> void;
+
+// Same for `k` row-major centroids of dimension `dim`.
+auto WriteResult(const std::string& output,
+                 const std::vector<double>& centroids, config::Size dim,
+                 const std::vector<config::Index>& labels) -> void;
@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <limits>
+
+#include "kdtree.hpp"
+#include "trace.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr auto kInf = std::numeric_limits<double>::infinity();
+
+// Relative rounding error tolerated while comparing distances to a cell.
+constexpr auto kSlack = 1e-12;
+
+// Nodes with at most that many points are not split.
+constexpr auto kLeafSize = config::Size{32};
+
+// Nodes above this depth are built and traversed as tasks.
+constexpr auto kTaskDepth = config::Size{8};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+KdTreeEngine::KdTreeEngine(Points& points, Clusters& clusters)
+    : points_(points), clusters_(clusters), order_(points.size()) {
+  const auto n = points_.size();
+  while ((n >> depth_) > kLeafSize) {
+    ++depth_;
+  }
+  nodes_.resize((config::Size{2} << depth_) - 1);
+
+  for (auto p = config::Index{0}; p < n; ++p) {
+    order_[p] = p;
+  }
+
+#pragma omp parallel num_threads(config::ThreadCount())
+#pragma omp single
+  Build(0, 0, n, 0);
+
+  x_.resize(n);
+  y_.resize(n);
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto i = config::Index{0}; i < n; ++i) {
+    x_[i] = points_[order_[i]].x;
+    y_[i] = points_[order_[i]].y;
+  }
+}
+
+auto KdTreeEngine::Assign() -> void {
+  Refresh();
+
+  auto candidates = std::vector<config::Index>(clusters_.size());
+  for (auto c = config::Index{0}; c < candidates.size(); ++c) {
+    candidates[c] = c;
+  }
+
+  auto stats = StepStats{};
+
+#pragma omp parallel num_threads(config::ThreadCount())
+#pragma omp single
+  stats = Filter(0, candidates, 0);
+
+  stats.skipped = points_.size() * clusters_.size() - stats.computed;
+  stats_ = stats;
+}
+
+auto KdTreeEngine::Update() -> bool {
+  refreshed_ = false;
+  return UpdateClusters(clusters_);
+}
+
+auto KdTreeEngine::Refresh() -> void {
+  if (refreshed_) {
+    return;
+  }
+
+  centroid_x_.resize(clusters_.size());
+  centroid_y_.resize(clusters_.size());
+  for (auto c = config::Index{0}; c < clusters_.size(); ++c) {
+    centroid_x_[c] = clusters_[c].Centroid().x;
+    centroid_y_[c] = clusters_[c].Centroid().y;
+  }
+
+  refreshed_ = true;
+}
+
+auto KdTreeEngine::LastStats() const -> StepStats {
+  return stats_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto KdTreeEngine::Build(config::Index node, config::Index first,
+                         config::Index last, config::Size depth) -> void {
+  auto& self = nodes_[node];
+  self.first = first;
+  self.last = last;
+
+  if (depth == depth_) {
+    self.min_x = self.min_y = kInf;
+    self.max_x = self.max_y = -kInf;
+    for (auto i = first; i < last; ++i) {
+      const auto& p = points_[order_[i]];
+      self.min_x = std::min(self.min_x, p.x);
+      self.min_y = std::min(self.min_y, p.y);
+      self.max_x = std::max(self.max_x, p.x);
+      self.max_y = std::max(self.max_y, p.y);
+      self.sum_x += p.weight * p.x;
+      self.sum_y += p.weight * p.y;
+      self.weight += p.weight;
+    }
+    return;
+  }
+
+  // The parent's box would do to pick the side, but it is not known yet:
+  // boxes are merged bottom-up. A pass over the range is cheap next to the
+  // selection below.
+  auto min_x = kInf;
+  auto min_y = kInf;
+  auto max_x = -kInf;
+  auto max_y = -kInf;
+  for (auto i = first; i < last; ++i) {
+    const auto& p = points_[order_[i]];
+    min_x = std::min(min_x, p.x);
+    min_y = std::min(min_y, p.y);
+    max_x = std::max(max_x, p.x);
+    max_y = std::max(max_y, p.y);
+  }
+
+  auto split_x = max_x - min_x >= max_y - min_y;
+  auto middle = first + (last - first) / 2;
+  std::nth_element(&order_[first], &order_[middle], &order_[0] + last,
+                   [this, split_x](config::Index a, config::Index b) {
+                     return split_x ? points_[a].x < points_[b].x
+                                    : points_[a].y < points_[b].y;
+                   });
+
+  auto left = 2 * node + 1;
+  auto right = 2 * node + 2;
+
+#pragma omp task if (depth < kTaskDepth)
+  Build(left, first, middle, depth + 1);
+
+  Build(right, middle, last, depth + 1);
+
+#pragma omp taskwait
+
+  const auto& a = nodes_[left];
+  const auto& b = nodes_[right];
+  self.min_x = std::min(a.min_x, b.min_x);
+  self.min_y = std::min(a.min_y, b.min_y);
+  self.max_x = std::max(a.max_x, b.max_x);
+  self.max_y = std::max(a.max_y, b.max_y);
+  self.sum_x = a.sum_x + b.sum_x;
+  self.sum_y = a.sum_y + b.sum_y;
+  self.weight = a.weight + b.weight;
+}
+
+auto KdTreeEngine::Filter(config::Index node,
+                          const std::vector<config::Index>& candidates,
+                          config::Size depth) -> StepStats {
+  const auto& self = nodes_[node];
+
+  if (candidates.size() == 1) {
+    return AssignSubtree(self, candidates.front());
+  }
+
+  // Candidate closest to the middle of the cell, lowest index on ties.
+  auto middle_x = (self.min_x + self.max_x) / 2;
+  auto middle_y = (self.min_y + self.max_y) / 2;
+  auto nearest = candidates.front();
+  auto min_dist = kInf;
+  for (auto c : candidates) {
+    auto dist = Distance2(c, middle_x, middle_y);
+    if (dist < min_dist) {
+      nearest = c;
+      min_dist = dist;
+    }
+  }
+
+  auto kept = std::vector<config::Index>{};
+  kept.reserve(candidates.size());
+  for (auto c : candidates) {
+    if (c == nearest || !Dominated(self, nearest, c)) {
+      kept.push_back(c);
+    }
+  }
+
+  if (kept.size() == 1) {
+    return AssignSubtree(self, nearest);
+  }
+
+  if (depth == depth_) {
+    return AssignLeaf(self, kept);
+  }
+
+  auto left = StepStats{};
+  auto right = StepStats{};
+
+#pragma omp task shared(left, kept) if (depth < kTaskDepth)
+  left = Filter(2 * node + 1, kept, depth + 1);
+
+  right = Filter(2 * node + 2, kept, depth + 1);
+
+#pragma omp taskwait
+
+  return {left.computed + right.computed, 0, left.changed + right.changed,
+          left.inertia + right.inertia};
+}
+
+// Squared distances of a point to `far` and `near` differ by a linear
+// function of the point, so it is enough to check the vertex of the cell
+// furthest in the direction from `near` to `far`.
+auto KdTreeEngine::Dominated(const Node& node, config::Index near,
+                             config::Index far) const -> bool {
+  auto x = centroid_x_[far] > centroid_x_[near] ? node.max_x : node.min_x;
+  auto y = centroid_y_[far] > centroid_y_[near] ? node.max_y : node.min_y;
+
+  auto far_dist = Distance2(far, x, y);
+  auto near_dist = Distance2(near, x, y);
+  return far_dist - near_dist > kSlack * (far_dist + near_dist);
+}
+
+auto KdTreeEngine::AssignSubtree(const Node& node, config::Index c)
+    -> StepStats {
+  TRACE_WORK();
+  auto stats = StepStats{};
+
+  for (auto i = node.first; i < node.last; ++i) {
+    auto& label = points_[order_[i]].cluster_index;
+    if (label != c) {
+      ++stats.changed;
+      label = c;
+    }
+    stats.inertia += Distance2(c, x_[i], y_[i]);
+  }
+
+  clusters_[c].Add(Point{node.sum_x, node.sum_y}, node.weight);
+  return stats;
+}
+
+auto KdTreeEngine::AssignLeaf(const Node& node,
+                              const std::vector<config::Index>& candidates)
+    -> StepStats {
+  TRACE_WORK();
+  auto stats = StepStats{};
+  stats.computed = (node.last - node.first) * candidates.size();
+
+  for (auto i = node.first; i < node.last; ++i) {
+    auto nearest = candidates.front();
+    auto min_dist = kInf;
+    for (auto c : candidates) {
+      auto dist = Distance2(c, x_[i], y_[i]);
+      if (dist < min_dist) {
+        nearest = c;
+        min_dist = dist;
+      }
+    }
+
+    auto& point = points_[order_[i]];
+    if (point.cluster_index != nearest) {
+      ++stats.changed;
+      point.cluster_index = nearest;
+    }
+    stats.inertia += min_dist;
+    clusters_[nearest].Add(point);
+  }
+
+  return stats;
+}
+
+auto KdTreeEngine::Distance2(config::Index c, double x, double y) const
+    -> double {
+  auto dx = x - centroid_x_[c];
+  auto dy = y - centroid_y_[c];
+  return dx * dx + dy * dy;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+
+#include "engine.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Filtering algorithm of Kanungo et al. Points are organized once into
+// a k-d tree caching the sum of every node. Traversal carries centroids
+// that may still be the nearest one to some point of a node's cell and
+// drops each one that is farther than the candidate closest to the cell's
+// middle from the whole cell. Once a single candidate is left, the whole
+// subtree is assigned to it and its cached sum is added at once.
+// Subtrees near the root are traversed as OpenMP tasks.
+// Yields exactly the same labels as `LloydEngine`.
+class KdTreeEngine : public IEngine {
+ public:
+  KdTreeEngine(Points& points, Clusters& clusters);
+
+  auto Assign() -> void override;
+  auto Update() -> bool override;
+  auto Refresh() -> void override;
+
+  auto LastStats() const -> StepStats override;
+
+ private:
+  struct Node {
+    // Bounding box of the points of the node.
+    double min_x{0};
+    double min_y{0};
+    double max_x{0};
+    double max_y{0};
+
+    // Weighted sum and total weight of the points of the node.
+    double sum_x{0};
+    double sum_y{0};
+    double weight{0};
+
+    config::Index first{0};  // range of `order_`
+    config::Index last{0};
+  };
+
+  // Splits `[first, last)` of `order_` at the median of the wider side,
+  // filling node `node` of the implicit tree and its subtree.
+  auto Build(config::Index node, config::Index first, config::Index last,
+             config::Size depth) -> void;
+
+  // Assigns points of the subtree of `node` to nearest of `candidates`
+  // (ascending indices), returns distances computed, changes and inertia.
+  auto Filter(config::Index node, const std::vector<config::Index>& candidates,
+              config::Size depth) -> StepStats;
+
+  // Whether centroid `far` is farther than `near` from every point of
+  // the cell of `node`.
+  auto Dominated(const Node& node, config::Index near, config::Index far) const
+      -> bool;
+
+  auto AssignSubtree(const Node& node, config::Index c) -> StepStats;
+  auto AssignLeaf(const Node& node,
+                  const std::vector<config::Index>& candidates) -> StepStats;
+
+  auto Distance2(config::Index c, double x, double y) const -> double;
+
+ private:
+  Points& points_;
+  Clusters& clusters_;
+
+  // Points in tree order, `order_[i]` is the index of point `i` in `points_`.
+  std::vector<config::Index> order_;
+  std::vector<double> x_;
+  std::vector<double> y_;
+
+  // Perfect binary tree, children of node `i` are `2i + 1` and `2i + 2`.
+  std::vector<Node> nodes_;
+  config::Size depth_{0};
+
+  std::vector<double> centroid_x_;
+  std::vector<double> centroid_y_;
+  bool refreshed_{false};
+
+  StepStats stats_{};
+};
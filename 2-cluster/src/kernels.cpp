@@ -0,0 +1,687 @@
+#include <array>
+#include <limits>
+
+#include <immintrin.h>
+
+#include "kernels.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr auto kInf = std::numeric_limits<double>::infinity();
+
+// Number of points swept over the centroids at once:
+// every centroid load is reused for the whole block.
+constexpr auto kPointBlock = config::Size{4};
+
+// Picks the lowest index among lanes holding the minimal distance.
+template <typename T, config::Size Width>
+auto ReduceLanes(const std::array<T, Width>& dist,
+                 const std::array<T, Width>& index) -> config::Index {
+  auto best = std::numeric_limits<T>::infinity();
+  auto nearest = std::numeric_limits<T>::max();
+
+  for (auto l = config::Size{0}; l < Width; ++l) {
+    if (dist[l] < best || (dist[l] == best && index[l] < nearest)) {
+      best = dist[l];
+      nearest = index[l];
+    }
+  }
+
+  return best == std::numeric_limits<T>::infinity()
+             ? 0
+             : static_cast<config::Index>(nearest);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto AssignScalar(const Centroids& centroids, Point* first, config::Size count)
+    -> void {
+  for (auto* p = first; p != first + count; ++p) {
+    auto nearest = config::Index{0};
+    auto min_dist = kInf;
+
+    for (auto i = config::Index{0}; i < centroids.Count(); ++i) {
+      auto dx = p->x - centroids.x[i];
+      auto dy = p->y - centroids.y[i];
+      if (auto dist = dx * dx + dy * dy; dist < min_dist) {
+        nearest = i;
+        min_dist = dist;
+      }
+    }
+
+    p->cluster_index = nearest;
+  }
+}
+
+template <config::Size D, typename T>
+auto RowDim(const BasicCentroidTable<T>& table) -> config::Size {
+  if constexpr (D == kDynamic) {
+    return table.Dim();
+  } else {
+    return D;
+  }
+}
+
+// Distances are summed from zero in the order of dimensions by every
+// variant, so the vector kernels agree with this one bit for bit.
+template <config::Size D, typename T>
+auto AssignRowsScalar(const BasicCentroidTable<T>& table, const T* rows,
+                      config::Size count, config::Index* labels) -> void {
+  const auto dim = RowDim<D>(table);
+
+  for (auto p = config::Index{0}; p < count; ++p) {
+    const auto* row = rows + p * dim;
+    auto nearest = config::Index{0};
+    auto min_dist = std::numeric_limits<T>::infinity();
+
+    for (auto i = config::Index{0}; i < table.Count(); ++i) {
+      auto dist = T{0};
+      for (auto d = config::Index{0}; d < dim; ++d) {
+        auto diff = row[d] - table.At(i, d);
+        dist += diff * diff;
+      }
+      if (dist < min_dist) {
+        nearest = i;
+        min_dist = dist;
+      }
+    }
+
+    labels[p] = nearest;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// FMA is deliberately not enabled: `dx * dx + dy * dy` has to round exactly
+// like the scalar fallback, otherwise near-ties could be resolved differently.
+
+template <config::Size Block>
+__attribute__((target("avx2"))) auto SweepAvx2(const Centroids& centroids,
+                                               Point* first) -> void {
+  constexpr auto kWidth = config::Size{4};
+
+  __m256d px[Block];
+  __m256d py[Block];
+  __m256d best[Block];
+  __m256d best_index[Block];
+
+  for (auto b = config::Size{0}; b < Block; ++b) {
+    px[b] = _mm256_set1_pd(first[b].x);
+    py[b] = _mm256_set1_pd(first[b].y);
+    best[b] = _mm256_set1_pd(kInf);
+    best_index[b] = _mm256_setzero_pd();
+  }
+
+  auto index = _mm256_setr_pd(0, 1, 2, 3);
+  const auto step = _mm256_set1_pd(kWidth);
+
+  for (auto i = config::Index{0}; i < centroids.PaddedCount(); i += kWidth) {
+    const auto cx = _mm256_loadu_pd(centroids.x.data() + i);
+    const auto cy = _mm256_loadu_pd(centroids.y.data() + i);
+
+    for (auto b = config::Size{0}; b < Block; ++b) {
+      const auto dx = _mm256_sub_pd(px[b], cx);
+      const auto dy = _mm256_sub_pd(py[b], cy);
+      const auto dist =
+          _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+
+      const auto closer = _mm256_cmp_pd(dist, best[b], _CMP_LT_OQ);
+      best[b] = _mm256_blendv_pd(best[b], dist, closer);
+      best_index[b] = _mm256_blendv_pd(best_index[b], index, closer);
+    }
+
+    index = _mm256_add_pd(index, step);
+  }
+
+  for (auto b = config::Size{0}; b < Block; ++b) {
+    auto dist = std::array<double, kWidth>{};
+    auto idx = std::array<double, kWidth>{};
+    _mm256_storeu_pd(dist.data(), best[b]);
+    _mm256_storeu_pd(idx.data(), best_index[b]);
+    first[b].cluster_index = ReduceLanes(dist, idx);
+  }
+}
+
+__attribute__((target("avx2"))) auto AssignAvx2(const Centroids& centroids,
+                                                Point* first,
+                                                config::Size count) -> void {
+  auto p = config::Index{0};
+  for (; p + kPointBlock <= count; p += kPointBlock) {
+    SweepAvx2<kPointBlock>(centroids, first + p);
+  }
+  for (; p < count; ++p) {
+    SweepAvx2<1>(centroids, first + p);
+  }
+}
+
+// AVX2 operations on vectors of `T`, so row kernels are written once for
+// both `double` and `float`.
+template <typename T>
+struct Avx2;
+
+template <>
+struct Avx2<double> {
+  using Vec = __m256d;
+  static constexpr auto kWidth = config::Size{4};
+
+  __attribute__((target("avx2"))) static auto Set(double v) -> Vec {
+    return _mm256_set1_pd(v);
+  }
+  __attribute__((target("avx2"))) static auto Zero() -> Vec {
+    return _mm256_setzero_pd();
+  }
+  __attribute__((target("avx2"))) static auto Iota() -> Vec {
+    return _mm256_setr_pd(0, 1, 2, 3);
+  }
+  __attribute__((target("avx2"))) static auto Load(const double* p) -> Vec {
+    return _mm256_loadu_pd(p);
+  }
+  __attribute__((target("avx2"))) static auto Store(double* p, Vec v) {
+    _mm256_storeu_pd(p, v);
+  }
+  __attribute__((target("avx2"))) static auto Sub(Vec a, Vec b) -> Vec {
+    return _mm256_sub_pd(a, b);
+  }
+  __attribute__((target("avx2"))) static auto Add(Vec a, Vec b) -> Vec {
+    return _mm256_add_pd(a, b);
+  }
+  __attribute__((target("avx2"))) static auto Mul(Vec a, Vec b) -> Vec {
+    return _mm256_mul_pd(a, b);
+  }
+  __attribute__((target("avx2"))) static auto Less(Vec a, Vec b) -> Vec {
+    return _mm256_cmp_pd(a, b, _CMP_LT_OQ);
+  }
+  // Lanes of `b` where `mask` is set, of `a` elsewhere.
+  __attribute__((target("avx2"))) static auto Blend(Vec a, Vec b, Vec mask)
+      -> Vec {
+    return _mm256_blendv_pd(a, b, mask);
+  }
+};
+
+template <>
+struct Avx2<float> {
+  using Vec = __m256;
+  static constexpr auto kWidth = config::Size{8};
+
+  __attribute__((target("avx2"))) static auto Set(float v) -> Vec {
+    return _mm256_set1_ps(v);
+  }
+  __attribute__((target("avx2"))) static auto Zero() -> Vec {
+    return _mm256_setzero_ps();
+  }
+  __attribute__((target("avx2"))) static auto Iota() -> Vec {
+    return _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+  }
+  __attribute__((target("avx2"))) static auto Load(const float* p) -> Vec {
+    return _mm256_loadu_ps(p);
+  }
+  __attribute__((target("avx2"))) static auto Store(float* p, Vec v) {
+    _mm256_storeu_ps(p, v);
+  }
+  __attribute__((target("avx2"))) static auto Sub(Vec a, Vec b) -> Vec {
+    return _mm256_sub_ps(a, b);
+  }
+  __attribute__((target("avx2"))) static auto Add(Vec a, Vec b) -> Vec {
+    return _mm256_add_ps(a, b);
+  }
+  __attribute__((target("avx2"))) static auto Mul(Vec a, Vec b) -> Vec {
+    return _mm256_mul_ps(a, b);
+  }
+  __attribute__((target("avx2"))) static auto Less(Vec a, Vec b) -> Vec {
+    return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+  }
+  __attribute__((target("avx2"))) static auto Blend(Vec a, Vec b, Vec mask)
+      -> Vec {
+    return _mm256_blendv_ps(a, b, mask);
+  }
+};
+
+template <config::Size D, config::Size Block, typename T>
+__attribute__((target("avx2"))) auto SweepRowsAvx2(
+    const BasicCentroidTable<T>& table, const T* rows, config::Index* labels)
+    -> void {
+  using V = Avx2<T>;
+  const auto dim = RowDim<D>(table);
+  const auto padded = table.PaddedCount();
+
+  typename V::Vec best[Block];
+  typename V::Vec best_index[Block];
+
+  for (auto b = config::Size{0}; b < Block; ++b) {
+    best[b] = V::Set(std::numeric_limits<T>::infinity());
+    best_index[b] = V::Zero();
+  }
+
+  auto index = V::Iota();
+  const auto step = V::Set(static_cast<T>(V::kWidth));
+
+  for (auto i = config::Index{0}; i < padded; i += V::kWidth) {
+    const auto* column = table.coords.data() + i;
+
+    typename V::Vec dist[Block];
+    for (auto b = config::Size{0}; b < Block; ++b) {
+      dist[b] = V::Zero();
+    }
+
+    for (auto d = config::Index{0}; d < dim; ++d) {
+      const auto c = V::Load(column + d * padded);
+      for (auto b = config::Size{0}; b < Block; ++b) {
+        const auto diff = V::Sub(V::Set(rows[b * dim + d]), c);
+        dist[b] = V::Add(dist[b], V::Mul(diff, diff));
+      }
+    }
+
+    for (auto b = config::Size{0}; b < Block; ++b) {
+      const auto closer = V::Less(dist[b], best[b]);
+      best[b] = V::Blend(best[b], dist[b], closer);
+      best_index[b] = V::Blend(best_index[b], index, closer);
+    }
+
+    index = V::Add(index, step);
+  }
+
+  for (auto b = config::Size{0}; b < Block; ++b) {
+    auto dist = std::array<T, V::kWidth>{};
+    auto idx = std::array<T, V::kWidth>{};
+    V::Store(dist.data(), best[b]);
+    V::Store(idx.data(), best_index[b]);
+    labels[b] = ReduceLanes(dist, idx);
+  }
+}
+
+template <config::Size D, typename T>
+__attribute__((target("avx2"))) auto AssignRowsAvx2(
+    const BasicCentroidTable<T>& table, const T* rows, config::Size count,
+    config::Index* labels) -> void {
+  const auto dim = RowDim<D>(table);
+
+  auto p = config::Index{0};
+  for (; p + kPointBlock <= count; p += kPointBlock) {
+    SweepRowsAvx2<D, kPointBlock>(table, rows + p * dim, labels + p);
+  }
+  for (; p < count; ++p) {
+    SweepRowsAvx2<D, 1>(table, rows + p * dim, labels + p);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <config::Size Block>
+__attribute__((target("avx512f"))) auto SweepAvx512(const Centroids& centroids,
+                                                    Point* first) -> void {
+  constexpr auto kWidth = config::Size{8};
+
+  __m512d px[Block];
+  __m512d py[Block];
+  __m512d best[Block];
+  __m512d best_index[Block];
+
+  for (auto b = config::Size{0}; b < Block; ++b) {
+    px[b] = _mm512_set1_pd(first[b].x);
+    py[b] = _mm512_set1_pd(first[b].y);
+    best[b] = _mm512_set1_pd(kInf);
+    best_index[b] = _mm512_setzero_pd();
+  }
+
+  auto index = _mm512_setr_pd(0, 1, 2, 3, 4, 5, 6, 7);
+  const auto step = _mm512_set1_pd(kWidth);
+
+  for (auto i = config::Index{0}; i < centroids.PaddedCount(); i += kWidth) {
+    const auto cx = _mm512_loadu_pd(centroids.x.data() + i);
+    const auto cy = _mm512_loadu_pd(centroids.y.data() + i);
+
+    for (auto b = config::Size{0}; b < Block; ++b) {
+      const auto dx = _mm512_sub_pd(px[b], cx);
+      const auto dy = _mm512_sub_pd(py[b], cy);
+      const auto dist =
+          _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy));
+
+      const auto closer = _mm512_cmp_pd_mask(dist, best[b], _CMP_LT_OQ);
+      best[b] = _mm512_mask_blend_pd(closer, best[b], dist);
+      best_index[b] = _mm512_mask_blend_pd(closer, best_index[b], index);
+    }
+
+    index = _mm512_add_pd(index, step);
+  }
+
+  for (auto b = config::Size{0}; b < Block; ++b) {
+    auto dist = std::array<double, kWidth>{};
+    auto idx = std::array<double, kWidth>{};
+    _mm512_storeu_pd(dist.data(), best[b]);
+    _mm512_storeu_pd(idx.data(), best_index[b]);
+    first[b].cluster_index = ReduceLanes(dist, idx);
+  }
+}
+
+__attribute__((target("avx512f"))) auto AssignAvx512(const Centroids& centroids,
+                                                     Point* first,
+                                                     config::Size count)
+    -> void {
+  auto p = config::Index{0};
+  for (; p + kPointBlock <= count; p += kPointBlock) {
+    SweepAvx512<kPointBlock>(centroids, first + p);
+  }
+  for (; p < count; ++p) {
+    SweepAvx512<1>(centroids, first + p);
+  }
+}
+
+// Same for AVX-512, comparisons yield bit masks instead of vectors.
+template <typename T>
+struct Avx512;
+
+template <>
+struct Avx512<double> {
+  using Vec = __m512d;
+  using Mask = __mmask8;
+  static constexpr auto kWidth = config::Size{8};
+
+  __attribute__((target("avx512f"))) static auto Set(double v) -> Vec {
+    return _mm512_set1_pd(v);
+  }
+  __attribute__((target("avx512f"))) static auto Zero() -> Vec {
+    return _mm512_setzero_pd();
+  }
+  __attribute__((target("avx512f"))) static auto Iota() -> Vec {
+    return _mm512_setr_pd(0, 1, 2, 3, 4, 5, 6, 7);
+  }
+  __attribute__((target("avx512f"))) static auto Load(const double* p)
+      -> Vec {
+    return _mm512_loadu_pd(p);
+  }
+  __attribute__((target("avx512f"))) static auto Store(double* p, Vec v) {
+    _mm512_storeu_pd(p, v);
+  }
+  __attribute__((target("avx512f"))) static auto Sub(Vec a, Vec b) -> Vec {
+    return _mm512_sub_pd(a, b);
+  }
+  __attribute__((target("avx512f"))) static auto Add(Vec a, Vec b) -> Vec {
+    return _mm512_add_pd(a, b);
+  }
+  __attribute__((target("avx512f"))) static auto Mul(Vec a, Vec b) -> Vec {
+    return _mm512_mul_pd(a, b);
+  }
+  __attribute__((target("avx512f"))) static auto Less(Vec a, Vec b) -> Mask {
+    return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ);
+  }
+  __attribute__((target("avx512f"))) static auto Blend(Vec a, Vec b,
+                                                       Mask mask) -> Vec {
+    return _mm512_mask_blend_pd(mask, a, b);
+  }
+};
+
+template <>
+struct Avx512<float> {
+  using Vec = __m512;
+  using Mask = __mmask16;
+  static constexpr auto kWidth = config::Size{16};
+
+  __attribute__((target("avx512f"))) static auto Set(float v) -> Vec {
+    return _mm512_set1_ps(v);
+  }
+  __attribute__((target("avx512f"))) static auto Zero() -> Vec {
+    return _mm512_setzero_ps();
+  }
+  __attribute__((target("avx512f"))) static auto Iota() -> Vec {
+    return _mm512_setr_ps(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+                          15);
+  }
+  __attribute__((target("avx512f"))) static auto Load(const float* p) -> Vec {
+    return _mm512_loadu_ps(p);
+  }
+  __attribute__((target("avx512f"))) static auto Store(float* p, Vec v) {
+    _mm512_storeu_ps(p, v);
+  }
+  __attribute__((target("avx512f"))) static auto Sub(Vec a, Vec b) -> Vec {
+    return _mm512_sub_ps(a, b);
+  }
+  __attribute__((target("avx512f"))) static auto Add(Vec a, Vec b) -> Vec {
+    return _mm512_add_ps(a, b);
+  }
+  __attribute__((target("avx512f"))) static auto Mul(Vec a, Vec b) -> Vec {
+    return _mm512_mul_ps(a, b);
+  }
+  __attribute__((target("avx512f"))) static auto Less(Vec a, Vec b) -> Mask {
+    return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ);
+  }
+  __attribute__((target("avx512f"))) static auto Blend(Vec a, Vec b,
+                                                       Mask mask) -> Vec {
+    return _mm512_mask_blend_ps(mask, a, b);
+  }
+};
+
+template <config::Size D, config::Size Block, typename T>
+__attribute__((target("avx512f"))) auto SweepRowsAvx512(
+    const BasicCentroidTable<T>& table, const T* rows, config::Index* labels)
+    -> void {
+  using V = Avx512<T>;
+  const auto dim = RowDim<D>(table);
+  const auto padded = table.PaddedCount();
+
+  typename V::Vec best[Block];
+  typename V::Vec best_index[Block];
+
+  for (auto b = config::Size{0}; b < Block; ++b) {
+    best[b] = V::Set(std::numeric_limits<T>::infinity());
+    best_index[b] = V::Zero();
+  }
+
+  auto index = V::Iota();
+  const auto step = V::Set(static_cast<T>(V::kWidth));
+
+  for (auto i = config::Index{0}; i < padded; i += V::kWidth) {
+    const auto* column = table.coords.data() + i;
+
+    typename V::Vec dist[Block];
+    for (auto b = config::Size{0}; b < Block; ++b) {
+      dist[b] = V::Zero();
+    }
+
+    for (auto d = config::Index{0}; d < dim; ++d) {
+      const auto c = V::Load(column + d * padded);
+      for (auto b = config::Size{0}; b < Block; ++b) {
+        const auto diff = V::Sub(V::Set(rows[b * dim + d]), c);
+        dist[b] = V::Add(dist[b], V::Mul(diff, diff));
+      }
+    }
+
+    for (auto b = config::Size{0}; b < Block; ++b) {
+      const auto closer = V::Less(dist[b], best[b]);
+      best[b] = V::Blend(best[b], dist[b], closer);
+      best_index[b] = V::Blend(best_index[b], index, closer);
+    }
+
+    index = V::Add(index, step);
+  }
+
+  for (auto b = config::Size{0}; b < Block; ++b) {
+    auto dist = std::array<T, V::kWidth>{};
+    auto idx = std::array<T, V::kWidth>{};
+    V::Store(dist.data(), best[b]);
+    V::Store(idx.data(), best_index[b]);
+    labels[b] = ReduceLanes(dist, idx);
+  }
+}
+
+template <config::Size D, typename T>
+__attribute__((target("avx512f"))) auto AssignRowsAvx512(
+    const BasicCentroidTable<T>& table, const T* rows, config::Size count,
+    config::Index* labels) -> void {
+  const auto dim = RowDim<D>(table);
+
+  auto p = config::Index{0};
+  for (; p + kPointBlock <= count; p += kPointBlock) {
+    SweepRowsAvx512<D, kPointBlock>(table, rows + p * dim, labels + p);
+  }
+  for (; p < count; ++p) {
+    SweepRowsAvx512<D, 1>(table, rows + p * dim, labels + p);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+using AssignFn = void (*)(const Centroids&, Point*, config::Size);
+
+enum class Level { kScalar, kAvx2, kAvx512 };
+
+struct Dispatch {
+  AssignFn assign;
+  Level level;
+  std::string_view isa;
+};
+
+auto Select() -> Dispatch {
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx512f")) {
+    return {AssignAvx512, Level::kAvx512, "avx512"};
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return {AssignAvx2, Level::kAvx2, "avx2"};
+  }
+  return {AssignScalar, Level::kScalar, "scalar"};
+}
+
+auto Selected() -> const Dispatch& {
+  static const auto dispatch = Select();
+  return dispatch;
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto Centroids::Load(const Clusters& clusters) -> void {
+  count_ = clusters.size();
+  auto lanes = kernels::kLanes;
+  auto padded = (count_ + lanes - 1) / lanes * lanes;
+
+  x.assign(padded, kInf);
+  y.assign(padded, kInf);
+
+  for (auto i = config::Index{0}; i < count_; ++i) {
+    x[i] = clusters[i].Centroid().x;
+    y[i] = clusters[i].Centroid().y;
+  }
+}
+
+auto Centroids::Select(const Centroids& all,
+                       const std::vector<config::Index>& indices) -> void {
+  count_ = indices.size();
+  auto lanes = kernels::kLanes;
+  auto padded = (count_ + lanes - 1) / lanes * lanes;
+
+  x.assign(padded, kInf);
+  y.assign(padded, kInf);
+
+  for (auto i = config::Index{0}; i < count_; ++i) {
+    x[i] = all.x[indices[i]];
+    y[i] = all.y[indices[i]];
+  }
+}
+
+auto Centroids::Count() const -> config::Size {
+  return count_;
+}
+
+auto Centroids::PaddedCount() const -> config::Size {
+  return x.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+auto BasicCentroidTable<T>::Load(const std::vector<double>& centroids,
+                                 config::Size dim) -> void {
+  dim_ = dim;
+  count_ = centroids.size() / dim;
+  auto lanes = kernels::kLanesOf<T>;
+  padded_count_ = (count_ + lanes - 1) / lanes * lanes;
+
+  coords.assign(dim_ * padded_count_, std::numeric_limits<T>::infinity());
+
+  for (auto c = config::Index{0}; c < count_; ++c) {
+    for (auto d = config::Index{0}; d < dim_; ++d) {
+      coords[d * padded_count_ + c] = static_cast<T>(centroids[c * dim_ + d]);
+    }
+  }
+}
+
+template <typename T>
+auto BasicCentroidTable<T>::Count() const -> config::Size {
+  return count_;
+}
+
+template <typename T>
+auto BasicCentroidTable<T>::PaddedCount() const -> config::Size {
+  return padded_count_;
+}
+
+template <typename T>
+auto BasicCentroidTable<T>::Dim() const -> config::Size {
+  return dim_;
+}
+
+template struct BasicCentroidTable<double>;
+template struct BasicCentroidTable<float>;
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace kernels {
+
+auto AssignNearest(const Centroids& centroids, Point* first, config::Size count)
+    -> void {
+  Selected().assign(centroids, first, count);
+}
+
+template <config::Size D, typename T>
+auto AssignNearest(const BasicCentroidTable<T>& table, const T* rows,
+                   config::Size count, config::Index* labels) -> void {
+  switch (Selected().level) {
+    case Level::kAvx512:
+      return AssignRowsAvx512<D>(table, rows, count, labels);
+    case Level::kAvx2:
+      return AssignRowsAvx2<D>(table, rows, count, labels);
+    case Level::kScalar:
+      return AssignRowsScalar<D>(table, rows, count, labels);
+  }
+}
+
+// Keep in sync with `Dimensions`.
+#define INSTANTIATE_ASSIGN_NEAREST(T)                                       \
+  template auto AssignNearest<2, T>(const BasicCentroidTable<T>&, const T*, \
+                                    config::Size, config::Index*) -> void;  \
+  template auto AssignNearest<3, T>(const BasicCentroidTable<T>&, const T*, \
+                                    config::Size, config::Index*) -> void;  \
+  template auto AssignNearest<4, T>(const BasicCentroidTable<T>&, const T*, \
+                                    config::Size, config::Index*) -> void;  \
+  template auto AssignNearest<8, T>(const BasicCentroidTable<T>&, const T*, \
+                                    config::Size, config::Index*) -> void;  \
+  template auto AssignNearest<16, T>(const BasicCentroidTable<T>&,          \
+                                     const T*, config::Size,                \
+                                     config::Index*) -> void;               \
+  template auto AssignNearest<32, T>(const BasicCentroidTable<T>&,          \
+                                     const T*, config::Size,                \
+                                     config::Index*) -> void;               \
+  template auto AssignNearest<64, T>(const BasicCentroidTable<T>&,          \
+                                     const T*, config::Size,                \
+                                     config::Index*) -> void;               \
+  template auto AssignNearest<128, T>(const BasicCentroidTable<T>&,         \
+                                      const T*, config::Size,               \
+                                      config::Index*) -> void;              \
+  template auto AssignNearest<kDynamic, T>(const BasicCentroidTable<T>&,    \
+                                           const T*, config::Size,          \
+                                           config::Index*) -> void;
+
+INSTANTIATE_ASSIGN_NEAREST(double)
+INSTANTIATE_ASSIGN_NEAREST(float)
+
+#undef INSTANTIATE_ASSIGN_NEAREST
+
+auto Isa() -> std::string_view {
+  return Selected().isa;
+}
+
+}  // namespace kernels
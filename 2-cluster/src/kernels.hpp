@@ -0,0 +1,99 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "config.hpp"
+#include "cluster.hpp"
+#include "dataset.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace kernels {
+
+// Widest vector any kernel operates on (AVX-512: 8 doubles, 16 floats).
+template <typename T>
+constexpr auto kLanesOf = config::Size{64 / sizeof(T)};
+
+constexpr auto kLanes = kLanesOf<double>;
+
+}  // namespace kernels
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Centroid coordinates in structure-of-arrays layout.
+// Arrays are padded up to a multiple of `kernels::kLanes` with centroids
+// at infinity, so kernels never need a scalar tail over centroids.
+struct Centroids {
+ public:
+  auto Load(const Clusters& clusters) -> void;
+
+  // Loads centroids `indices` of `all` only, `i`-th of them becomes `i`.
+  auto Select(const Centroids& all, const std::vector<config::Index>& indices)
+      -> void;
+
+  auto Count() const -> config::Size;
+  auto PaddedCount() const -> config::Size;
+
+ public:
+  std::vector<double> x;
+  std::vector<double> y;
+
+ private:
+  config::Size count_{0};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Centroids of any dimension, transposed to `dim` rows of `PaddedCount()`
+// coordinates of type `T`, padded like `Centroids` up to
+// `kernels::kLanesOf<T>`. Instantiated for `double` and `float`.
+template <typename T>
+struct BasicCentroidTable {
+ public:
+  // Takes `centroids` row-major, `dim` coordinates per centroid.
+  auto Load(const std::vector<double>& centroids, config::Size dim) -> void;
+
+  auto Count() const -> config::Size;
+  auto PaddedCount() const -> config::Size;
+  auto Dim() const -> config::Size;
+
+  // Coordinate `d` of centroid `c`.
+  auto At(config::Index c, config::Index d) const -> T {
+    return coords[d * padded_count_ + c];
+  }
+
+ public:
+  std::vector<T> coords;
+
+ private:
+  config::Size count_{0};
+  config::Size padded_count_{0};
+  config::Size dim_{0};
+};
+
+using CentroidTable = BasicCentroidTable<double>;
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace kernels {
+
+// Sets `cluster_index` of every point in `[first, first + count)` to the
+// nearest centroid by squared distance. Ties are broken towards the lowest
+// centroid index, exactly like a sequential scan with `<` would.
+auto AssignNearest(const Centroids& centroids, Point* first, config::Size count)
+    -> void;
+
+// Sets `labels[i]` to the nearest centroid of row-major point
+// `rows + i * table.Dim()` for every `i < count`, with the same tie rule.
+// The dimension is a compile-time constant unless `D` is `kDynamic`:
+// instantiated for `Dimensions` and `kDynamic` only, with distances
+// computed in `T` (`double` or `float`, twice as many lanes).
+template <config::Size D, typename T = double>
+auto AssignNearest(const BasicCentroidTable<T>& table, const T* rows,
+                   config::Size count, config::Index* labels) -> void;
+
+// Instruction set chosen by runtime dispatch: "avx512", "avx2" or "scalar".
+auto Isa() -> std::string_view;
+
+}  // namespace kernels
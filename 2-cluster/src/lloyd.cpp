@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <vector>
+
+#include "lloyd.hpp"
+#include "parallel.hpp"
+#include "trace.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr auto kInf = std::numeric_limits<double>::infinity();
+
+// Relative rounding error tolerated between box and point distances.
+constexpr auto kSlack = 1e-12;
+
+// Centroids that may be the nearest one to some point of a block.
+struct Candidates {
+  std::vector<config::Index> indices;  // ascending, so ties still go low
+  Centroids centroids;
+};
+
+// Collects centroids not farther from the bounding box of `count` points
+// than the farthest corner of the box is from the closest centroid: others
+// can't be the nearest centroid of any point inside. Returns whether any
+// centroid was pruned. On blocks of spatially sorted points (see `Order`)
+// most centroids are.
+auto PruneBlock(const Centroids& all, const Point* first, config::Size count,
+                Candidates& candidates) -> bool {
+  auto min_x = kInf;
+  auto min_y = kInf;
+  auto max_x = -kInf;
+  auto max_y = -kInf;
+  for (const auto* p = first; p < first + count; ++p) {
+    min_x = std::min(min_x, p->x);
+    min_y = std::min(min_y, p->y);
+    max_x = std::max(max_x, p->x);
+    max_y = std::max(max_y, p->y);
+  }
+
+  auto lower = [&](config::Index c) {
+    auto dx = std::max({min_x - all.x[c], 0.0, all.x[c] - max_x});
+    auto dy = std::max({min_y - all.y[c], 0.0, all.y[c] - max_y});
+    return dx * dx + dy * dy;
+  };
+
+  auto bound = kInf;
+  for (auto c = config::Index{0}; c < all.Count(); ++c) {
+    auto dx = std::max(all.x[c] - min_x, max_x - all.x[c]);
+    auto dy = std::max(all.y[c] - min_y, max_y - all.y[c]);
+    bound = std::min(bound, dx * dx + dy * dy);
+  }
+  bound *= 1 + kSlack;
+
+  candidates.indices.clear();
+  for (auto c = config::Index{0}; c < all.Count(); ++c) {
+    if (lower(c) <= bound) {
+      candidates.indices.push_back(c);
+    }
+  }
+
+  if (candidates.indices.size() == all.Count()) {
+    return false;
+  }
+
+  candidates.centroids.Select(all, candidates.indices);
+  return true;
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+LloydEngine::LloydEngine(Points& points, Clusters& clusters)
+    : points_(points), clusters_(clusters), sums_(clusters) {
+}
+
+auto LloydEngine::Assign() -> void {
+  Refresh();
+
+  auto block_count =
+      (points_.size() + config::kBlockSize - 1) / config::kBlockSize;
+  block_changes_.resize(block_count);
+  sums_.Reset();
+
+  stats_ = parallel::Reduce<StepStats>(
+      block_count, 1, [this](config::Index first, config::Index last) {
+        auto stats = StepStats{};
+        for (auto b = first; b < last; ++b) {
+          TRACE_WORK();
+          auto block = StepStats{};
+          AssignBlock(b, block);
+          stats += block;
+        }
+        return stats;
+      });
+
+  sums_.Flush();
+
+  stats_.skipped = points_.size() * clusters_.size() - stats_.computed;
+}
+
+auto LloydEngine::Update() -> bool {
+  refreshed_ = false;
+  return UpdateClusters(clusters_);
+}
+
+auto LloydEngine::Refresh() -> void {
+  if (!refreshed_) {
+    centroids_.Load(clusters_);
+    refreshed_ = true;
+  }
+}
+
+auto LloydEngine::LastStats() const -> StepStats {
+  return stats_;
+}
+
+auto LloydEngine::BlockChanges() const -> const std::vector<config::Size>& {
+  return block_changes_;
+}
+
+auto LloydEngine::AssignBlock(config::Index b, StepStats& stats) -> void {
+  auto first = b * config::kBlockSize;
+  auto last = std::min(points_.size(), first + config::kBlockSize);
+
+  // Labels of the last iteration, compared in the accumulation loop below.
+  auto previous = std::array<config::Index, config::kBlockSize>{};
+  for (auto p = first; p < last; ++p) {
+    previous[p - first] = points_[p].cluster_index;
+  }
+
+  thread_local auto candidates = Candidates{};
+
+  if (PruneBlock(centroids_, &points_[first], last - first, candidates)) {
+    kernels::AssignNearest(candidates.centroids, &points_[first], last - first);
+    for (auto p = first; p < last; ++p) {
+      auto& label = points_[p].cluster_index;
+      label = candidates.indices[label];
+    }
+    stats.computed += (last - first) * candidates.indices.size();
+  } else {
+    kernels::AssignNearest(centroids_, &points_[first], last - first);
+    stats.computed += (last - first) * centroids_.Count();
+  }
+
+  auto& sums = sums_.Local();
+  auto changed = config::Size{0};
+
+  for (auto p = first; p < last; ++p) {
+    auto c = points_[p].cluster_index;
+    auto dx = points_[p].x - centroids_.x[c];
+    auto dy = points_[p].y - centroids_.y[c];
+
+    if (c != previous[p - first]) {
+      ++changed;
+    }
+    stats.inertia += dx * dx + dy * dy;
+    sums[c].Add(points_[p]);
+  }
+
+  stats.changed += changed;
+  block_changes_[b] = changed;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+
+#include "engine.hpp"
+#include "kernels.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Plain Lloyd iteration: every point is compared against every centroid
+// that may be the nearest one to its block, see `PruneBlock`.
+class LloydEngine : public IEngine {
+ public:
+  LloydEngine(Points& points, Clusters& clusters);
+
+  auto Assign() -> void override;
+  auto Update() -> bool override;
+  auto Refresh() -> void override;
+
+  auto LastStats() const -> StepStats override;
+
+  // Points of block `b` that changed cluster in the last `Assign`.
+  // Blocks without changes are candidates for skipping in later iterations.
+  auto BlockChanges() const -> const std::vector<config::Size>&;
+
+ private:
+  // Assigns points of block `b` and accumulates them into clusters.
+  // Adds evaluated distances, changed points and their squared distances
+  // to `stats`.
+  auto AssignBlock(config::Index b, StepStats& stats) -> void;
+
+ private:
+  Points& points_;
+  Clusters& clusters_;
+  Centroids centroids_;
+  DomainSums sums_;
+  bool refreshed_{false};
+
+  StepStats stats_{};
+  std::vector<config::Size> block_changes_;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+#include <mpi.h>
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define EXPECT_OK(call)                                             \
+  do {                                                              \
+    const auto ec = call;                                           \
+    if (ec != MPI_SUCCESS) {                                        \
+      MPI_Abort(MPI_COMM_WORLD, ec);                                \
+      const auto ec_str = std::to_string(ec);                       \
+      throw std::runtime_error("MPI call failed: " #call + ec_str); \
+    }                                                               \
+  } while (false)
@@ -1,17 +1,273 @@
 #include <chrono>
 #include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
 
 #include "config.hpp"
+#include "bench.hpp"
+#include "io.hpp"
+#include "numa.hpp"
+#include "parallel.hpp"
 #include "solver.hpp"
+#include "trace.hpp"
+#include "world-guard.hpp"
 
 // NOLINTNEXTLINE
 using namespace config;
 
-auto RunTests(std::ostream& log = std::cerr) -> void {
+struct Options {
+  Params params{};
+  int threads{kThreadCount};
+  // Static with `--pin` unless given: see `numa::TouchBlocks`.
+  std::optional<Schedule> schedule;
+  Backend backend{Backend::kOpenMp};
+  bool pin{false};
+  bool stats{false};
+  bool predict{false};  // serve training points again, see `PrintPredictions`
+  bool compare_seeding{false};
+  bool binary{false};   // read `data/<test>.bin` instead of `data/<test>`
+  bool convert{false};  // only write `data/<test>.bin` for every test
+
+  // Sweep of `RunBenchmark` instead of tests, written to `bench_output`
+  // or to standard output.
+  bool bench{false};
+  Benchmark benchmark{};
+  std::string bench_output;
+
+  // Directories of `<test>` files to warm-start from (such as `results`)
+  // and to write checkpoints to, see `Params::warm_start`.
+  std::string warm_start;
+  std::string checkpoint;
+
+  // Chrome trace and CSV summary of every run, see `trace.hpp`.
+  std::string trace_output;
+  std::string trace_csv;
+};
+
+// Comma-separated list of `parse(item)`.
+template <typename Parse>
+auto ParseList(std::string_view list, Parse parse) {
+  auto items = std::vector<decltype(parse(list))>{};
+  while (!list.empty()) {
+    auto comma = std::min(list.find(','), list.size());
+    items.push_back(parse(list.substr(0, comma)));
+    list.remove_prefix(std::min(comma + 1, list.size()));
+  }
+  return items;
+}
+
+// Accepts "1e8" as well as "100000000".
+auto ParseCount(std::string_view value) -> Size {
+  return static_cast<Size>(std::stod(std::string{value}));
+}
+
+auto InputPath(const Options& options, int test) -> std::string {
+  return "data/" + std::to_string(test) + (options.binary ? ".bin" : "");
+}
+
+auto ParseOptions(int argc, char** argv) -> Options {
+  auto options = Options{};
+
+  for (auto i = 1; i < argc; ++i) {
+    auto arg = std::string_view{argv[i]};  // NOLINT
+    auto value = arg.substr(arg.find('=') + 1);
+
+    if (arg.starts_with("--engine=")) {
+      options.params.mode = ParseMode(value);
+    } else if (arg.starts_with("--seeding=")) {
+      options.params.seeding = ParseSeeding(value);
+    } else if (arg.starts_with("--seed=")) {
+      options.params.seed = std::stoull(std::string{value});
+    } else if (arg.starts_with("--stream=")) {
+      options.params.chunk_size = std::stoull(std::string{value});
+    } else if (arg.starts_with("--epochs=")) {
+      options.params.epochs = std::stoull(std::string{value});
+    } else if (arg.starts_with("--precision=")) {
+      options.params.precision = ParsePrecision(value);
+    } else if (arg.starts_with("--order=")) {
+      options.params.order = ParseOrder(value);
+    } else if (arg.starts_with("--coreset=")) {
+      options.params.coreset_size = ParseCount(value);
+    } else if (arg.starts_with("--eps=")) {
+      options.params.eps = std::stod(std::string{value});
+    } else if (arg.starts_with("--min-points=")) {
+      options.params.min_points = std::stoull(std::string{value});
+    } else if (arg.starts_with("--restarts=")) {
+      options.params.restarts = std::stoull(std::string{value});
+    } else if (arg == "--deterministic") {
+      options.params.deterministic = true;
+    } else if (arg.starts_with("--warm-start=")) {
+      options.warm_start = value;
+    } else if (arg.starts_with("--checkpoint=")) {
+      options.checkpoint = value;
+    } else if (arg.starts_with("--checkpoint-every=")) {
+      options.params.checkpoint_every = ParseCount(value);
+    } else if (arg == "--mpi") {
+      options.params.distributed = true;
+    } else if (arg == "--overlap") {
+      options.params.overlap = true;
+    } else if (arg.starts_with("--max-iterations=")) {
+      options.params.stop.max_iterations = std::stoull(std::string{value});
+    } else if (arg == "--stop-unchanged") {
+      options.params.stop.unchanged = true;
+    } else if (arg.starts_with("--change-ratio=")) {
+      options.params.stop.change_ratio = std::stod(std::string{value});
+    } else if (arg.starts_with("--inertia-tolerance=")) {
+      options.params.stop.inertia_tolerance = std::stod(std::string{value});
+    } else if (arg.starts_with("--threads=")) {
+      options.threads = std::stoi(std::string{value});
+    } else if (arg.starts_with("--backend=")) {
+      options.backend = ParseBackend(value);
+    } else if (arg.starts_with("--bench-backends=")) {
+      options.benchmark.backends = ParseList(value, ParseBackend);
+    } else if (arg.starts_with("--schedule=")) {
+      options.schedule = ParseSchedule(value);
+    } else if (arg == "--pin") {
+      options.pin = options.benchmark.pin = true;
+    } else if (arg == "--bench") {
+      options.bench = true;
+    } else if (arg.starts_with("--bench-points=")) {
+      options.benchmark.sizes = ParseList(value, ParseCount);
+    } else if (arg.starts_with("--bench-clusters=")) {
+      options.benchmark.cluster_counts = ParseList(value, ParseCount);
+    } else if (arg.starts_with("--bench-dimension=")) {
+      options.benchmark.dimension = ParseCount(value);
+    } else if (arg.starts_with("--bench-threads=")) {
+      options.benchmark.threads = ParseList(value, [](std::string_view item) {
+        return std::stoi(std::string{item});
+      });
+    } else if (arg.starts_with("--bench-schedules=")) {
+      options.benchmark.schedules = ParseList(value, ParseSchedule);
+    } else if (arg.starts_with("--bench-dir=")) {
+      options.benchmark.directory = value;
+    } else if (arg.starts_with("--bench-output=")) {
+      options.bench_output = value;
+    } else if (arg.starts_with("--trace=")) {
+      options.trace_output = value;
+    } else if (arg.starts_with("--trace-csv=")) {
+      options.trace_csv = value;
+    } else if (arg == "--predict") {
+      options.predict = true;
+    } else if (arg == "--stats") {
+      options.stats = true;
+    } else if (arg == "--binary") {
+      options.binary = true;
+    } else if (arg == "--convert") {
+      options.convert = true;
+    } else if (arg == "--compare-seeding") {
+      options.compare_seeding = true;
+    } else {
+      throw std::invalid_argument("Unknown argument: " + std::string{arg});
+    }
+  }
+
+  if (!trace::kEnabled &&
+      (!options.trace_output.empty() || !options.trace_csv.empty())) {
+    throw std::invalid_argument("Tracing needs a -DCLUSTER_TRACE=ON build");
+  }
+
+  options.benchmark.params = options.params;
+  return options;
+}
+
+auto PrintStats(std::ostream& out, int test, const Report& report) -> void {
+  auto iteration = report.resumed;
+  for (const auto& s : report.history) {
+    out << "test " << test << ", iteration " << ++iteration << ": "
+        << s.computed << " distances, " << std::fixed << std::setprecision(2)
+        << 100 * s.SkippedFraction() << "% skipped, " << s.changed
+        << " changed\n";
+  }
+
+  if (!report.stop_reason.empty()) {
+    out << "test " << test << ", stopped: " << report.stop_reason << '\n';
+  }
+
+  auto restart = 0;
+  for (auto inertia : report.restart_inertia) {
+    out << "test " << test << ", restart " << restart++ << ": inertia "
+        << std::setprecision(10) << inertia << '\n';
+  }
+}
+
+// Points per second of `count` points labelled in `duration`.
+auto Rate(Size count, Mcs duration) -> double {
+  return static_cast<double>(count) /
+         (static_cast<double>(std::max<Mcs::rep>(duration.count(), 1)) * 1e-6);
+}
+
+// Labels the points of `input` again with what the last run of `solver`
+// kept. The model predicts them with and without its grid index, which must
+// agree, then absorbs them: centroids of a converged run are already the
+// means of their points, so they should barely move. Bisecting runs label
+// them with their tree instead.
+auto PrintPredictions(std::ostream& out, int test, const Solver& solver,
+                      const std::string& input, Mode mode) -> void {
+  auto points = Points{};
+  ReadDataset(input, points);
+  out << "test " << test << ", predict: " << std::fixed
+      << std::setprecision(2);
+
+  if (mode == Mode::kBisecting) {
+    auto start = Clock::now();
+    solver.LastTree().Predict(points);
+    out << "tree " << Rate(points.size(), Since(start)) * 1e-6
+        << " M points/s\n" << std::defaultfloat;
+    return;
+  }
+
+  auto plain = solver.LastModel(false);
+  auto start = Clock::now();
+  plain.Predict(points);
+  auto plain_rate = Rate(points.size(), Since(start));
+
+  auto indexed_points = points;
+  auto indexed = solver.LastModel(true);
+  start = Clock::now();
+  indexed.Predict(indexed_points);
+  auto indexed_rate = Rate(points.size(), Since(start));
+
+  for (auto p = Index{0}; p < points.size(); ++p) {
+    if (points[p].cluster_index != indexed_points[p].cluster_index) {
+      throw std::runtime_error("Grid index changes the label of point " +
+                               std::to_string(p) + " of " + input);
+    }
+  }
+
+  plain.Absorb(points);
+  auto shift = 0.0;
+  for (auto c = Index{0}; c < plain.Count(); ++c) {
+    shift = std::max(shift, plain.Centroid(c).DistanceTo(
+                                indexed.Centroid(c)));
+  }
+
+  out << plain_rate * 1e-6 << " M points/s, indexed " << indexed_rate * 1e-6
+      << " M points/s, same labels; absorbing them moves centroids by "
+      << std::scientific << std::setprecision(1) << shift << '\n'
+      << std::defaultfloat;
+}
+
+auto RunTests(const Options& options, std::ostream& log = std::cerr) -> void {
+  auto stats = std::stringstream{};
+
   for (auto test = 1; test <= kTestCount; ++test) {
-    auto solver = Solver{};
-    auto input = "data/" + std::to_string(test);
+    auto params = options.params;
+    if (!options.warm_start.empty()) {
+      params.warm_start = options.warm_start + '/' + std::to_string(test);
+    }
+    if (!options.checkpoint.empty()) {
+      std::filesystem::create_directories(options.checkpoint);
+      params.checkpoint = options.checkpoint + '/' + std::to_string(test);
+    }
+
+    auto solver = Solver{params};
+    auto input = InputPath(options, test);
     auto output = "results/" + std::to_string(test);
 
     auto start = Clock::now();
@@ -19,12 +275,95 @@ auto RunTests(std::ostream& log = std::cerr) -> void {
     auto dur = std::chrono::duration_cast<Mcs>(Clock::now() - start).count();
 
     log << dur << (test == kTestCount ? "" : ", ");
+
+    if (options.stats) {
+      PrintStats(stats, test, solver.LastReport());
+    }
+    if (options.predict) {
+      PrintPredictions(stats, test, solver, input, params.mode);
+    }
+  }
+
+  log << '\n' << stats.str() << std::flush;
+}
+
+// Runs every test with every seeding strategy, one CSV row per run.
+auto CompareSeeding(const Options& options, std::ostream& log = std::cerr)
+    -> void {
+  log << "test,seeding,iterations,seeding_us,total_us,inertia\n";
+
+  for (auto test = 1; test <= kTestCount; ++test) {
+    for (auto seeding :
+         {Seeding::kRandom, Seeding::kPlusPlus, Seeding::kParallel}) {
+      auto params = options.params;
+      params.seeding = seeding;
+
+      auto solver = Solver{params};
+      auto input = InputPath(options, test);
+      auto output = "results/" + std::to_string(test);
+
+      auto start = Clock::now();
+      solver.Solve(input, output);
+      auto dur = std::chrono::duration_cast<Mcs>(Clock::now() - start).count();
+
+      const auto& report = solver.LastReport();
+      log << test << ',' << ToString(seeding) << ','
+          << report.history.size() << ',' << report.seeding.count() << ','
+          << dur << ',' << std::setprecision(10) << report.inertia << '\n';
+    }
   }
 
   log << std::flush;
 }
 
-auto main() -> int {
-  std::srand(11);
-  RunTests();
+auto ConvertTests() -> void {
+  for (auto test = 1; test <= kTestCount; ++test) {
+    auto input = "data/" + std::to_string(test);
+
+    auto points = Points{};
+    auto cluster_count = ReadDataset(input, points);
+    WriteBinary(input + ".bin", points, cluster_count);
+  }
+}
+
+auto main(int argc, char** argv) -> int {
+  auto options = ParseOptions(argc, argv);
+
+  std::srand(static_cast<unsigned>(options.params.seed));
+
+  SetThreadCount(options.threads);
+  SetSchedule(options.schedule.value_or(
+      options.pin ? Schedule{Schedule::Kind::kStatic} : Schedule{}));
+  parallel::SetBackend(options.backend);
+  if (options.pin) {
+    numa::PinThreads();
+  }
+
+  if (options.bench) {
+    if (options.bench_output.empty()) {
+      RunBenchmark(options.benchmark, std::cout);
+    } else {
+      auto out = std::ofstream{options.bench_output};
+      RunBenchmark(options.benchmark, out);
+    }
+  } else if (options.params.distributed) {
+    auto guard = WorldGuard{argc, argv};
+    auto quiet = std::ostringstream{};
+    RunTests(options, guard.rank == 0 ? std::cerr : quiet);
+  } else if (options.convert) {
+    ConvertTests();
+  } else if (options.compare_seeding) {
+    CompareSeeding(options);
+  } else {
+    RunTests(options);
+  }
+
+  if (!options.trace_output.empty()) {
+    auto out = std::ofstream{options.trace_output};
+    trace::WriteChrome(out);
+  }
+  if (!options.trace_csv.empty()) {
+    auto out = std::ofstream{options.trace_csv};
+    trace::WriteCsv(out);
+  }
 }
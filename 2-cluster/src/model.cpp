@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "model.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr auto kInf = std::numeric_limits<double>::infinity();
+
+// Relative rounding error tolerated between cell and point distances.
+constexpr auto kSlack = 1e-12;
+
+// The grid extends that many times the span of centroids on every side.
+constexpr auto kGridMargin = 0.5;
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+Model::Model(const Clusters& clusters, std::vector<double> weights,
+             bool indexed)
+    : clusters_(clusters), weights_(std::move(weights)), indexed_(indexed) {
+  if (clusters_.empty() || weights_.size() != clusters_.size()) {
+    throw std::invalid_argument("Model needs a weight for every centroid");
+  }
+  Load();
+}
+
+auto Model::Predict(Points& points) const -> void {
+  const auto n = points.size();
+  const auto blocks = (n + config::kBlockSize - 1) / config::kBlockSize;
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(runtime)
+  for (auto b = config::Index{0}; b < blocks; ++b) {
+    auto first = b * config::kBlockSize;
+    PredictBlock(&points[first], std::min(config::kBlockSize, n - first));
+  }
+}
+
+auto Model::Absorb(Points& points) -> void {
+  Predict(points);
+
+  auto sums = Clusters(clusters_.size());
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(runtime)
+  for (auto p = config::Index{0}; p < points.size(); ++p) {
+    sums[points[p].cluster_index].Add(points[p]);
+  }
+
+  for (auto c = config::Index{0}; c < clusters_.size(); ++c) {
+    auto [sum, weight] = sums[c].Pending();
+    if (weight == 0) {
+      continue;
+    }
+
+    auto& centroid = clusters_[c].Centroid();
+    auto total = weights_[c] + weight;
+    centroid.x = (weights_[c] * centroid.x + sum.x) / total;
+    centroid.y = (weights_[c] * centroid.y + sum.y) / total;
+    weights_[c] = total;
+  }
+
+  Load();
+}
+
+auto Model::Count() const -> config::Size {
+  return clusters_.size();
+}
+
+auto Model::Centroid(config::Index c) const -> const Point& {
+  return clusters_[c].Centroid();
+}
+
+auto Model::Weight(config::Index c) const -> double {
+  return weights_[c];
+}
+
+auto Model::Index(bool indexed) -> void {
+  indexed_ = indexed;
+  Load();
+}
+
+auto Model::Indexed() const -> bool {
+  return indexed_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto Model::Load() -> void {
+  centroids_.Load(clusters_);
+  grid_ = {};
+  if (indexed_) {
+    BuildGrid();
+  }
+}
+
+auto Model::BuildGrid() -> void {
+  const auto k = centroids_.Count();
+
+  const auto* xs = centroids_.x.data();
+  const auto* ys = centroids_.y.data();
+  auto [min_x, max_x] = std::minmax_element(xs, xs + k);
+  auto [min_y, max_y] = std::minmax_element(ys, ys + k);
+
+  // Degenerate spans get a unit one, so that cells never have zero size.
+  auto span_x = *max_x - *min_x > 0 ? *max_x - *min_x : 1.0;
+  auto span_y = *max_y - *min_y > 0 ? *max_y - *min_y : 1.0;
+
+  auto side = static_cast<config::Size>(
+      std::ceil(std::sqrt(static_cast<double>(k))));
+
+  grid_.min_x = *min_x - kGridMargin * span_x;
+  grid_.min_y = *min_y - kGridMargin * span_y;
+  grid_.cell_width = (1 + 2 * kGridMargin) * span_x / static_cast<double>(side);
+  grid_.cell_height =
+      (1 + 2 * kGridMargin) * span_y / static_cast<double>(side);
+  grid_.columns = grid_.rows = side;
+  grid_.cells.resize(side * side);
+
+  const auto& all = centroids_;
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto i = config::Index{0}; i < grid_.cells.size(); ++i) {
+    auto left = grid_.min_x +
+                static_cast<double>(i % side) * grid_.cell_width;
+    auto bottom = grid_.min_y +
+                  static_cast<double>(i / side) * grid_.cell_height;
+    auto right = left + grid_.cell_width;
+    auto top = bottom + grid_.cell_height;
+
+    auto bound = kInf;
+    for (auto c = config::Index{0}; c < k; ++c) {
+      auto dx = std::max(all.x[c] - left, right - all.x[c]);
+      auto dy = std::max(all.y[c] - bottom, top - all.y[c]);
+      bound = std::min(bound, dx * dx + dy * dy);
+    }
+    bound *= 1 + kSlack;
+
+    auto& cell = grid_.cells[i];
+    for (auto c = config::Index{0}; c < k; ++c) {
+      auto dx = std::max({left - all.x[c], 0.0, all.x[c] - right});
+      auto dy = std::max({bottom - all.y[c], 0.0, all.y[c] - top});
+      if (dx * dx + dy * dy <= bound) {
+        cell.indices.push_back(c);
+      }
+    }
+    cell.centroids.Select(all, cell.indices);
+  }
+}
+
+auto Model::PredictBlock(Point* first, config::Size count) const -> void {
+  if (!indexed_) {
+    kernels::AssignNearest(centroids_, first, count);
+    return;
+  }
+
+  for (auto* p = first; p < first + count; ++p) {
+    auto column = std::floor((p->x - grid_.min_x) / grid_.cell_width);
+    auto row = std::floor((p->y - grid_.min_y) / grid_.cell_height);
+
+    // Also false for NaN coordinates.
+    if (!(column >= 0 && column < static_cast<double>(grid_.columns) &&
+          row >= 0 && row < static_cast<double>(grid_.rows))) {
+      kernels::AssignNearest(centroids_, p, 1);
+      continue;
+    }
+
+    const auto& cell = grid_.cells[static_cast<config::Index>(row) *
+                                       grid_.columns +
+                                   static_cast<config::Index>(column)];
+    kernels::AssignNearest(cell.centroids, p, 1);
+    p->cluster_index = cell.indices[p->cluster_index];
+  }
+}
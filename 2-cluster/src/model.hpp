@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+
+#include "config.hpp"
+#include "cluster.hpp"
+#include "kernels.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Trained centroids serving new points after `Solve`: `Predict` labels
+// batches of points, `Absorb` folds them into the centroids as running means
+// without the training data, so every centroid stays the mean of all points
+// ever assigned to it (the training ones with their last labels).
+class Model {
+ public:
+  // `weights[c]` is the number (or total weight) of points behind
+  // centroid `c`. `indexed` builds the grid index, see `Index`.
+  Model(const Clusters& clusters, std::vector<double> weights,
+        bool indexed = false);
+
+  // Sets `cluster_index` of every point to its nearest centroid, blocks of
+  // points in parallel. Ties go to the lowest index with or without index.
+  auto Predict(Points& points) const -> void;
+
+  // Predicts `points` and moves their centroids to the weighted mean of
+  // previous and new points. Centroids without new points stay in place.
+  auto Absorb(Points& points) -> void;
+
+  auto Count() const -> config::Size;
+  auto Centroid(config::Index c) const -> const Point&;
+  auto Weight(config::Index c) const -> double;
+
+  // Builds or drops the grid index, which pays off for large `k`.
+  auto Index(bool indexed) -> void;
+  auto Indexed() const -> bool;
+
+ private:
+  // Uniform grid of about `k` cells around the centroids. Every cell lists
+  // the centroids that can be the nearest to some point within it: those
+  // whose distance to the cell does not exceed the smallest distance of
+  // any centroid to the farthest corner of the cell from it. Points off
+  // the grid are compared to all centroids.
+  struct Grid {
+    struct Cell {
+      Centroids centroids;
+      std::vector<config::Index> indices;  // into all centroids
+    };
+
+    double min_x{0};
+    double min_y{0};
+    double cell_width{1};
+    double cell_height{1};
+    config::Size columns{0};
+    config::Size rows{0};
+    std::vector<Cell> cells;  // row by row
+  };
+
+  auto Load() -> void;
+  auto BuildGrid() -> void;
+
+  auto PredictBlock(Point* first, config::Size count) const -> void;
+
+ private:
+  Clusters clusters_;
+  std::vector<double> weights_;
+
+  Centroids centroids_;
+  bool indexed_{false};
+  Grid grid_;
+};
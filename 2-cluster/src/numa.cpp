@@ -0,0 +1,194 @@
+#include <omp.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "numa.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// Domain of every CPU, indexed by CPU number.
+struct Topology {
+  std::vector<config::Index> domain_of;
+  config::Size domains{1};
+};
+
+// Parses a CPU list like "0-3,8-11".
+auto ParseCpuList(const std::string& list) -> std::vector<config::Index> {
+  auto cpus = std::vector<config::Index>{};
+
+  auto in = std::istringstream{list};
+  auto range = std::string{};
+  while (std::getline(in, range, ',')) {
+    auto dash = range.find('-');
+    auto first = std::stoul(range.substr(0, dash));
+    auto last = dash == std::string::npos ? first
+                                          : std::stoul(range.substr(dash + 1));
+    for (auto cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+
+  return cpus;
+}
+
+auto ReadTopology() -> Topology {
+  auto topology = Topology{};
+  auto domain = config::Index{0};
+
+  auto nodes = std::vector<std::filesystem::path>{};
+  auto error = std::error_code{};
+  for (const auto& entry : std::filesystem::directory_iterator{
+           "/sys/devices/system/node", error}) {
+    auto name = entry.path().filename().string();
+    if (name.starts_with("node") && name.size() > 4 &&
+        std::isdigit(name[4]) != 0) {
+      nodes.push_back(entry.path());
+    }
+  }
+  std::sort(nodes.begin(), nodes.end());
+
+  for (const auto& node : nodes) {
+    auto list = std::string{};
+    std::getline(std::ifstream{node / "cpulist"}, list);
+
+    auto cpus = ParseCpuList(list);
+    if (cpus.empty()) {
+      continue;  // memory-only node
+    }
+
+    for (auto cpu : cpus) {
+      if (cpu >= topology.domain_of.size()) {
+        topology.domain_of.resize(cpu + 1, 0);
+      }
+      topology.domain_of[cpu] = domain;
+    }
+    ++domain;
+  }
+
+  topology.domains = std::max(domain, config::Size{1});
+  return topology;
+}
+
+auto GetTopology() -> const Topology& {
+  static const auto kTopology = ReadTopology();
+  return kTopology;
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace numa {
+
+auto Domains() -> config::Size {
+  return GetTopology().domains;
+}
+
+auto ThreadDomain() -> config::Index {
+  const auto& topology = GetTopology();
+  if (topology.domains == 1) {
+    return 0;
+  }
+
+  auto cpu = sched_getcpu();
+  if (cpu < 0 || static_cast<config::Size>(cpu) >= topology.domain_of.size()) {
+    return 0;
+  }
+  return topology.domain_of[static_cast<config::Size>(cpu)];
+}
+
+auto PinThreads() -> void {
+  const auto& topology = GetTopology();
+
+  auto allowed = cpu_set_t{};
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+    return;
+  }
+
+  auto cpus = std::vector<config::Index>{};
+  for (auto cpu = config::Index{0}; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &allowed)) {
+      cpus.push_back(cpu);
+    }
+  }
+
+  auto domain = [&topology](config::Index cpu) {
+    return cpu < topology.domain_of.size() ? topology.domain_of[cpu] : 0;
+  };
+  std::stable_sort(cpus.begin(), cpus.end(),
+                   [&domain](auto a, auto b) { return domain(a) < domain(b); });
+
+  const auto threads = static_cast<config::Size>(config::ThreadCount());
+
+#pragma omp parallel num_threads(config::ThreadCount())
+  {
+    auto t = static_cast<config::Size>(omp_get_thread_num());
+    auto set = cpu_set_t{};
+    CPU_ZERO(&set);
+    CPU_SET(cpus[t * cpus.size() / threads], &set);
+    sched_setaffinity(0, sizeof(set), &set);
+  }
+}
+
+auto Placement(const void* address) -> std::vector<config::Size> {
+  auto placement = std::vector<config::Size>{};
+
+  auto in = std::ifstream{"/proc/self/numa_maps"};
+  auto target = reinterpret_cast<std::uintptr_t>(address);  // NOLINT
+  auto best = std::uintptr_t{0};
+
+  // Mappings are listed by start address only: the one holding `address`
+  // is the last one starting at or below it.
+  auto line = std::string{};
+  while (std::getline(in, line)) {
+    auto start = std::stoull(line.substr(0, line.find(' ')), nullptr, 16);
+    if (start > target || start < best) {
+      continue;
+    }
+
+    best = start;
+    placement.clear();
+
+    auto fields = std::istringstream{line};
+    auto field = std::string{};
+    while (fields >> field) {
+      // "N<node>=<pages>"
+      auto equals = field.find('=');
+      if (field.size() < 2 || field[0] != 'N' || equals == std::string::npos ||
+          std::isdigit(field[1]) == 0) {
+        continue;
+      }
+
+      auto node = std::stoul(field.substr(1, equals - 1));
+      if (node >= placement.size()) {
+        placement.resize(node + 1, 0);
+      }
+      placement[node] = std::stoull(field.substr(equals + 1));
+    }
+  }
+
+  return placement;
+}
+
+auto TouchBlocks(void* data, std::size_t bytes, std::size_t block) -> void {
+  auto* first = static_cast<char*>(data);
+  auto blocks = (bytes + block - 1) / block;
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto b = config::Index{0}; b < blocks; ++b) {
+    auto offset = b * block;
+    std::memset(first + offset, 0, std::min(block, bytes - offset));
+  }
+}
+
+}  // namespace numa
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "config.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// NUMA topology from `/sys/devices/system/node`, no libnuma needed.
+// Machines without it look like a single domain.
+namespace numa {
+
+// Number of NUMA domains (nodes with CPUs), at least one.
+auto Domains() -> config::Size;
+
+// Domain of the CPU the calling thread runs on, in `[0, Domains())`.
+auto ThreadDomain() -> config::Index;
+
+// Binds thread `t` of a `config::ThreadCount()` team to a single CPU, CPUs
+// ordered by domain: consecutive threads share a domain, so the static
+// partition of points puts every domain's threads on adjacent ranges.
+// Affects later parallel regions of the same size.
+auto PinThreads() -> void;
+
+// Pages of the mapping holding `address` resident on every node, as
+// reported by `/proc/self/numa_maps`; empty if it is unavailable.
+auto Placement(const void* address) -> std::vector<config::Size>;
+
+// Writes zeros over `bytes` bytes at `data` in blocks of `block` bytes,
+// distributed over threads like `schedule(static)` distributes
+// `config::kBlockSize` point blocks. Assignment loops follow
+// `config::SetSchedule`, so threads work on their own pages only with a
+// static schedule, the default with `--pin`.
+auto TouchBlocks(void* data, std::size_t bytes, std::size_t block) -> void;
+
+// Allocations smaller than that are not worth a parallel region.
+constexpr auto kFirstTouchBytes = std::size_t{1} << 20;
+
+// Places large arrays by first touch: fresh memory is touched by the threads
+// that will work on it before elements are constructed, so pages land on
+// their domains instead of the one of the allocating thread.
+template <typename T>
+struct FirstTouchAllocator : std::allocator<T> {
+  using value_type = T;
+
+  FirstTouchAllocator() = default;
+
+  template <typename U>
+  FirstTouchAllocator(const FirstTouchAllocator<U>& /*other*/) noexcept {
+  }
+
+  auto allocate(std::size_t n) -> T* {
+    auto* data = std::allocator<T>::allocate(n);
+    if (n * sizeof(T) >= kFirstTouchBytes) {
+      TouchBlocks(data, n * sizeof(T), config::kBlockSize * sizeof(T));
+    }
+    return data;
+  }
+};
+
+}  // namespace numa
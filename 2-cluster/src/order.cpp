@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "order.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr auto kCoordBits = 16;
+constexpr auto kCells = std::uint32_t{1} << kCoordBits;
+
+constexpr auto kRadixBits = 8;
+constexpr auto kBuckets = config::Size{1} << kRadixBits;
+
+struct Keyed {
+  std::uint32_t key;
+  config::Index index;
+};
+
+// Spreads the 16 low bits of `v` to even positions.
+auto Spread(std::uint32_t v) -> std::uint32_t {
+  v = (v | (v << 8)) & 0x00FF00FFU;
+  v = (v | (v << 4)) & 0x0F0F0F0FU;
+  v = (v | (v << 2)) & 0x33333333U;
+  v = (v | (v << 1)) & 0x55555555U;
+  return v;
+}
+
+auto MortonKey(std::uint32_t x, std::uint32_t y) -> std::uint32_t {
+  return Spread(x) | (Spread(y) << 1);
+}
+
+// Distance of cell `(x, y)` along the Hilbert curve filling the grid.
+auto HilbertKey(std::uint32_t x, std::uint32_t y) -> std::uint32_t {
+  auto key = std::uint32_t{0};
+  for (auto s = kCells / 2; s > 0; s /= 2) {
+    auto rx = (x & s) != 0 ? 1U : 0U;
+    auto ry = (y & s) != 0 ? 1U : 0U;
+    key += s * s * ((3 * rx) ^ ry);
+
+    // Rotate the quadrant so the curve stays continuous.
+    if (ry == 0) {
+      if (rx == 1) {
+        x = kCells - 1 - x;
+        y = kCells - 1 - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return key;
+}
+
+struct Box {
+  double min_x;
+  double min_y;
+  double max_x;
+  double max_y;
+};
+
+auto BoundingBox(const Points& points) -> Box {
+  auto min_x = std::numeric_limits<double>::infinity();
+  auto min_y = min_x;
+  auto max_x = -min_x;
+  auto max_y = -min_x;
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static) reduction(min:min_x, min_y) reduction(max:max_x, max_y)
+  for (auto p = config::Index{0}; p < points.size(); ++p) {
+    min_x = std::min(min_x, points[p].x);
+    min_y = std::min(min_y, points[p].y);
+    max_x = std::max(max_x, points[p].x);
+    max_y = std::max(max_y, points[p].y);
+  }
+
+  return {min_x, min_y, max_x, max_y};
+}
+
+// Cell of `value` among `kCells` cells of `[min, min + extent]`.
+auto Quantize(double value, double min, double extent) -> std::uint32_t {
+  if (extent <= 0) {
+    return 0;
+  }
+  auto cell = (value - min) / extent * static_cast<double>(kCells - 1);
+  return static_cast<std::uint32_t>(cell);
+}
+
+// Stable LSD radix sort by `key`, a byte per pass. Every range of items
+// counts its own histogram, so scattering needs no synchronization.
+auto RadixSort(std::vector<Keyed>& items) -> void {
+  const auto n = items.size();
+  const auto ranges = static_cast<config::Size>(config::ThreadCount());
+
+  auto buffer = std::vector<Keyed>(n);
+  auto counts = std::vector<std::array<config::Size, kBuckets>>(ranges);
+
+  for (auto shift = 0; shift < 32; shift += kRadixBits) {
+    auto bucket = [shift](const Keyed& item) {
+      return (item.key >> shift) & (kBuckets - 1);
+    };
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+    for (auto r = config::Index{0}; r < ranges; ++r) {
+      counts[r].fill(0);
+      for (auto i = r * n / ranges; i < (r + 1) * n / ranges; ++i) {
+        ++counts[r][bucket(items[i])];
+      }
+    }
+
+    // Exclusive offsets: bucket-major, then range, which keeps it stable.
+    auto offset = config::Size{0};
+    for (auto b = config::Index{0}; b < kBuckets; ++b) {
+      for (auto r = config::Index{0}; r < ranges; ++r) {
+        offset += std::exchange(counts[r][b], offset);
+      }
+    }
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+    for (auto r = config::Index{0}; r < ranges; ++r) {
+      auto& next = counts[r];
+      for (auto i = r * n / ranges; i < (r + 1) * n / ranges; ++i) {
+        buffer[next[bucket(items[i])]++] = items[i];
+      }
+    }
+
+    items.swap(buffer);
+  }
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto ParseOrder(std::string_view name) -> Order {
+  if (name == "none") {
+    return Order::kNone;
+  }
+  if (name == "morton") {
+    return Order::kMorton;
+  }
+  if (name == "hilbert") {
+    return Order::kHilbert;
+  }
+  throw std::invalid_argument("Unknown order: " + std::string{name});
+}
+
+auto ToString(Order order) -> std::string_view {
+  switch (order) {
+    case Order::kNone:
+      return "none";
+    case Order::kMorton:
+      return "morton";
+    case Order::kHilbert:
+      return "hilbert";
+  }
+  return "unknown";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto SortPoints(Order order, Points& points) -> std::vector<config::Index> {
+  const auto n = points.size();
+  auto permutation = std::vector<config::Index>(n);
+
+  if (order == Order::kNone) {
+    for (auto p = config::Index{0}; p < n; ++p) {
+      permutation[p] = p;
+    }
+    return permutation;
+  }
+
+  auto box = BoundingBox(points);
+  auto extent_x = box.max_x - box.min_x;
+  auto extent_y = box.max_y - box.min_y;
+
+  auto items = std::vector<Keyed>(n);
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto p = config::Index{0}; p < n; ++p) {
+    auto x = Quantize(points[p].x, box.min_x, extent_x);
+    auto y = Quantize(points[p].y, box.min_y, extent_y);
+    auto key = order == Order::kMorton ? MortonKey(x, y) : HilbertKey(x, y);
+    items[p] = {key, p};
+  }
+
+  RadixSort(items);
+
+  auto sorted = Points(n);
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto p = config::Index{0}; p < n; ++p) {
+    permutation[p] = items[p].index;
+    sorted[p] = points[items[p].index];
+  }
+
+  points.swap(sorted);
+  return permutation;
+}
+
+auto RestoreOrder(const std::vector<config::Index>& permutation,
+                  Points& points) -> void {
+  auto restored = Points(points.size());
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto p = config::Index{0}; p < points.size(); ++p) {
+    restored[permutation[p]] = points[p];
+  }
+
+  points.swap(restored);
+}
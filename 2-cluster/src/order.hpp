@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "config.hpp"
+#include "cluster.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Layout of points in memory. Along a space-filling curve, consecutive
+// blocks of points cover small tiles of the plane, so their nearest
+// centroids are few and the rest can be pruned per block.
+enum class Order {
+  kNone,     // file order
+  kMorton,   // Z-order: interleaved coordinate bits
+  kHilbert,  // Hilbert curve: no jumps between adjacent cells
+};
+
+auto ParseOrder(std::string_view name) -> Order;
+auto ToString(Order order) -> std::string_view;
+
+// Sorts `points` along the curve of `order` (by a parallel radix sort of
+// 32-bit keys over a 65536 x 65536 grid of their bounding box).
+// Returns the permutation: sorted point `i` was point `result[i]`.
+auto SortPoints(Order order, Points& points) -> std::vector<config::Index>;
+
+// Puts points back in the order they had before `SortPoints`.
+auto RestoreOrder(const std::vector<config::Index>& permutation,
+                  Points& points) -> void;
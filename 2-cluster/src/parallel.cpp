@@ -0,0 +1,214 @@
+#include <omp.h>
+
+#include <atomic>
+#include <execution>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include <await/executors/static_thread_pool.hpp>
+#ifdef CLUSTER_HAS_TBB
+#include <tbb/global_control.h>
+#endif
+
+#include "parallel.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// NOLINTNEXTLINE
+auto backend = Backend::kOpenMp;
+
+// NOLINTNEXTLINE
+auto pool = await::executors::IThreadPoolPtr{};
+// NOLINTNEXTLINE
+auto pool_owned = false;
+// NOLINTNEXTLINE
+auto pool_threads = 0;  // of the owned pool
+
+// Worker index within a loop on the pool, 0 for the calling thread.
+thread_local auto pool_worker = config::Index{0};
+
+// Shared with pool tasks, which may start after the loop is over: they
+// find no chunks left then and never touch `chunk`.
+struct Loop {
+  const std::function<void(config::Index)>* chunk{nullptr};
+  config::Size chunks{0};
+  std::atomic<config::Index> next{0};
+  std::atomic<config::Size> done{0};
+};
+
+auto Work(Loop& loop, config::Index worker) -> void {
+  pool_worker = worker;
+  for (auto c = loop.next++; c < loop.chunks; c = loop.next++) {
+    (*loop.chunk)(c);
+    if (++loop.done == loop.chunks) {
+      loop.done.notify_all();
+    }
+  }
+}
+
+// The owned pool follows `config::ThreadCount()`, a pool set by
+// `SetThreadPool` is used as is.
+auto Pool() -> await::executors::IExecutor& {
+  if (pool_owned && pool_threads != config::ThreadCount()) {
+    pool->Join();
+    pool = {};
+  }
+  if (!pool) {
+    pool_threads = config::ThreadCount();
+    pool = await::executors::MakeStaticThreadPool(
+        static_cast<config::Size>(pool_threads));
+    pool_owned = true;
+  }
+  return *pool;
+}
+
+#ifdef CLUSTER_HAS_TBB
+// NOLINTNEXTLINE
+auto tbb_limit = std::optional<tbb::global_control>{};
+// NOLINTNEXTLINE
+auto tbb_threads = 0;
+#endif
+
+// Holds TBB, which runs `std::execution` policies, to
+// `config::ThreadCount()` threads instead of all cores.
+auto LimitStdThreads() -> void {
+#ifdef CLUSTER_HAS_TBB
+  if (tbb_threads != config::ThreadCount()) {
+    tbb_limit.reset();
+    tbb_threads = config::ThreadCount();
+    tbb_limit.emplace(tbb::global_control::max_allowed_parallelism,
+                      static_cast<std::size_t>(tbb_threads));
+  }
+#endif
+}
+
+// Type erasure of `await` tasks makes GCC see a null closure once inlined.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wnull-dereference"
+
+auto RunOnPool(config::Size chunks,
+               const std::function<void(config::Index)>& chunk) -> void {
+  auto& executor = Pool();
+  auto tasks = std::min(chunks, static_cast<config::Size>(
+                                    config::ThreadCount())) - 1;
+
+  auto loop = std::make_shared<Loop>();
+  loop->chunk = &chunk;
+  loop->chunks = chunks;
+
+  for (auto t = config::Index{1}; t <= tasks; ++t) {
+    executor.Execute([loop, t] { Work(*loop, t); });
+  }
+
+  // Finishes chunks of tasks that didn't start yet, if any.
+  Work(*loop, 0);
+  for (auto done = loop->done.load(); done < chunks;
+       done = loop->done.load()) {
+    loop->done.wait(done);
+  }
+}
+
+#pragma GCC diagnostic pop
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto ParseBackend(std::string_view name) -> Backend {
+  if (name == "openmp") {
+    return Backend::kOpenMp;
+  }
+  if (name == "std") {
+    return Backend::kStd;
+  }
+  if (name == "pool") {
+    return Backend::kPool;
+  }
+  throw std::invalid_argument("Unknown backend: " + std::string{name});
+}
+
+auto ToString(Backend backend) -> std::string_view {
+  switch (backend) {
+    case Backend::kOpenMp:
+      return "openmp";
+    case Backend::kStd:
+      return "std";
+    case Backend::kPool:
+      return "pool";
+  }
+  return "unknown";
+}
+
+namespace parallel {
+
+auto SetBackend(Backend value) -> void {
+  backend = value;
+}
+
+auto GetBackend() -> Backend {
+  return backend;
+}
+
+auto SetThreadPool(await::executors::IThreadPoolPtr value) -> void {
+  if (pool_owned) {
+    pool->Join();
+  }
+  pool = std::move(value);
+  pool_owned = false;
+}
+
+auto ForChunks(config::Size chunks,
+               const std::function<void(config::Index)>& chunk) -> void {
+  if (chunks == 0) {
+    return;
+  }
+
+  switch (backend) {
+    case Backend::kOpenMp: {
+      // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(runtime)
+      for (auto c = config::Index{0}; c < chunks; ++c) {
+        chunk(c);
+      }
+      return;
+    }
+
+    case Backend::kStd: {
+      // Not `par_unseq`: chunks add to clusters with atomics.
+      LimitStdThreads();
+      auto indices = std::vector<config::Index>(chunks);
+      std::iota(indices.begin(), indices.end(), config::Index{0});
+      std::for_each(std::execution::par, indices.begin(), indices.end(),
+                    chunk);
+      return;
+    }
+
+    case Backend::kPool:
+      RunOnPool(chunks, chunk);
+      return;
+  }
+}
+
+auto WorkerIndex() -> config::Index {
+  // OpenMP loops run whatever the backend, e.g. the k-d tree's.
+  if (omp_in_parallel() != 0) {
+    return static_cast<config::Index>(omp_get_thread_num());
+  }
+
+  switch (backend) {
+    case Backend::kOpenMp:
+      return 0;
+    case Backend::kStd:
+      return kNoWorker;
+    case Backend::kPool:
+      return pool_worker;
+  }
+  return kNoWorker;
+}
+
+}  // namespace parallel
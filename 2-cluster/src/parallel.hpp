@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+#include <await/executors/thread_pool.hpp>
+
+#include "config.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Runtime of the parallel loops of an iteration (assignment, cluster
+// updates, fixed-order sums). Other loops (reading, seeding, the k-d tree)
+// always run on OpenMP.
+enum class Backend {
+  kOpenMp,  // `parallel for` over chunks, `schedule(runtime)`
+  kStd,     // `std::for_each(std::execution::par, ...)` over chunks
+  kPool,    // chunks pulled by tasks of an `await` thread pool
+};
+
+auto ParseBackend(std::string_view name) -> Backend;
+auto ToString(Backend backend) -> std::string_view;
+
+namespace parallel {
+
+// Process-wide, like `config::ThreadCount()`.
+auto SetBackend(Backend backend) -> void;
+auto GetBackend() -> Backend;
+
+// Pool of `Backend::kPool`, e.g. one owned by an embedding service. Until
+// set, a pool of `config::ThreadCount()` threads is made on first use. A
+// loop runs on `config::ThreadCount() - 1` tasks of the pool plus the
+// calling thread, which also finishes chunks of tasks that didn't start:
+// loops may be called from a thread of the pool itself.
+auto SetThreadPool(await::executors::IThreadPoolPtr pool) -> void;
+
+// Calls `chunk(c)` for every `c < chunks`, in parallel on the backend.
+auto ForChunks(config::Size chunks,
+               const std::function<void(config::Index)>& chunk) -> void;
+
+// Index below `config::ThreadCount()` of the calling thread within the
+// current loop, `kNoWorker` if the backend doesn't tell (`kStd`). For
+// `trace.hpp`.
+constexpr auto kNoWorker = ~config::Index{0};
+auto WorkerIndex() -> config::Index;
+
+// Calls `body(first, last)` for consecutive ranges of `grain` indices
+// covering `[0, n)`.
+template <typename Body>
+auto For(config::Size n, config::Size grain, Body body) -> void {
+  ForChunks((n + grain - 1) / grain, [&](config::Index c) {
+    body(c * grain, std::min(n, (c + 1) * grain));
+  });
+}
+
+// Like `For`, adding up the results of `body` with `+=` in range order,
+// so the result depends on `grain` only.
+template <typename T, typename Body>
+auto Reduce(config::Size n, config::Size grain, Body body) -> T {
+  auto parts = std::vector<T>((n + grain - 1) / grain);
+  ForChunks(parts.size(), [&](config::Index c) {
+    parts[c] = body(c * grain, std::min(n, (c + 1) * grain));
+  });
+
+  auto total = T{};
+  for (const auto& part : parts) {
+    total += part;
+  }
+  return total;
+}
+
+}  // namespace parallel
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "config.hpp"
+#include "convergence.hpp"
+#include "engine.hpp"
+#include "order.hpp"
+#include "precision.hpp"
+#include "seeding.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct Params {
+  Mode mode{Mode::kLloyd};
+  Seeding seeding{Seeding::kRandom};
+  std::uint64_t seed{11};  // `kRandom` draws from `std::rand()` instead
+
+  // Streaming mini-batch mode reading that many points at a time,
+  // the whole dataset is loaded into memory when zero.
+  config::Size chunk_size{0};
+  config::Size epochs{1};  // training passes over the file in streaming mode
+
+  // Every MPI rank clusters its own shard of the dataset, see
+  // `DistributedSolver`.
+  bool distributed{false};
+  bool overlap{false};  // overlap global reductions with bound updates
+
+  // Independently seeded runs, the one with the lowest inertia is kept.
+  // See `RestartSolver`.
+  config::Size restarts{1};
+
+  StopRules stop{};
+
+  // Layout of points while iterating, labels are written in file order
+  // regardless. In-memory 2D datasets only.
+  Order order{Order::kNone};
+
+  // Iterates on a weighted sample of that many points, see `BuildCoreset`,
+  // then labels all points by their nearest final centroid. Zero (or a size
+  // not below the number of points) iterates on all of them. In-memory 2D
+  // datasets only.
+  config::Size coreset_size{0};
+
+  // Neighbourhood radius and size making a core point, `Mode::kDbscan` only.
+  double eps{0};
+  config::Size min_points{4};
+
+  // Anything but `kDouble` runs on the dense path, see `DenseSolver`.
+  Precision precision{Precision::kDouble};
+
+  // Sums centroids and inertia in a fixed order, see `FixedSums`, so results
+  // are bit-identical for any thread count and schedule. In-memory runs
+  // only.
+  bool deterministic{false};
+
+  // Centroids to start from instead of seeding, see `ReadCheckpoint`. A
+  // checkpoint resumes its run: its iterations count towards
+  // `StopRules::max_iterations`. In-memory 2D runs only.
+  std::string warm_start;
+
+  // Checkpoint written every `checkpoint_every` iterations and once done,
+  // see `CheckpointWriter`. In-memory 2D runs only.
+  std::string checkpoint;
+  config::Size checkpoint_every{10};
+};
+
+// Measurements of the last `Solve`.
+struct Report {
+  std::vector<StepStats> history;  // one entry per iteration
+  config::Size resumed{0};  // iterations run before, by a warm start
+
+  // Time spent in every phase, assignment and update summed over iterations.
+  config::Mcs read{0};
+  config::Mcs seeding{0};
+  config::Mcs coreset{0};  // building it, the final labelling is `assign`
+  config::Mcs reorder{0};
+  config::Mcs assign{0};
+  config::Mcs update{0};
+  config::Mcs write{0};
+
+  double inertia{0};  // sum of squared distances to assigned centroids
+  std::vector<double> restart_inertia;  // of every restart, if any
+  std::string_view stop_reason;
+
+  // Resident pages of points on every NUMA node, see `numa::Placement`.
+  std::vector<config::Size> placement;
+};
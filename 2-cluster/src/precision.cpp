@@ -0,0 +1,31 @@
+#include <stdexcept>
+#include <string>
+
+#include "precision.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto ParsePrecision(std::string_view name) -> Precision {
+  if (name == "double") {
+    return Precision::kDouble;
+  }
+  if (name == "float") {
+    return Precision::kFloat;
+  }
+  if (name == "mixed") {
+    return Precision::kMixed;
+  }
+  throw std::invalid_argument("Unknown precision: " + std::string{name});
+}
+
+auto ToString(Precision precision) -> std::string_view {
+  switch (precision) {
+    case Precision::kDouble:
+      return "double";
+    case Precision::kFloat:
+      return "float";
+    case Precision::kMixed:
+      return "mixed";
+  }
+  return "unknown";
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string_view>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Scalar type of coordinates while iterating, see `DenseSolver`.
+enum class Precision {
+  kDouble,
+  kFloat,  // float coordinates, distances and per-thread sums
+  kMixed,  // float coordinates and distances, double sums
+};
+
+auto ParsePrecision(std::string_view name) -> Precision;
+auto ToString(Precision precision) -> std::string_view;
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+
+#include "config.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// SplitMix64: tiny, fast, and good enough to seed and draw from per block.
+class Random {
+ public:
+  explicit Random(std::uint64_t seed) : state_(seed) {
+  }
+
+  Random(std::uint64_t seed, std::uint64_t stream, std::uint64_t block)
+      : Random(seed ^ Random{stream * 0x9E3779B97F4A7C15ULL + block}.Next()) {
+  }
+
+  auto Next() -> std::uint64_t {
+    auto z = (state_ += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  // Uniform in [0, 1).
+  auto Uniform() -> double {
+    return static_cast<double>(Next() >> 11) * 0x1.0p-53;
+  }
+
+  // Uniform in [0, n).
+  auto Below(config::Size n) -> config::Index {
+    return static_cast<config::Index>(Next() % n);
+  }
+
+  // Standard normal, by Box-Muller (the second deviate is dropped).
+  auto Normal() -> double {
+    auto radius = std::sqrt(-2 * std::log1p(-Uniform()));
+    return radius * std::cos(2 * std::numbers::pi * Uniform());
+  }
+
+ private:
+  std::uint64_t state_;
+};
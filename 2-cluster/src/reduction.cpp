@@ -0,0 +1,106 @@
+#include <array>
+
+#include "reduction.hpp"
+#include "trace.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace reduction {
+
+auto GroupBounds(config::Size n) -> std::vector<config::Index> {
+  const auto blocks = (n + config::kBlockSize - 1) / config::kBlockSize;
+  const auto groups = std::max(config::Size{1}, std::min(kGroups, blocks));
+
+  auto bounds = std::vector<config::Index>(groups + 1);
+  for (auto g = config::Index{0}; g <= groups; ++g) {
+    bounds[g] = std::min(n, g * blocks / groups * config::kBlockSize);
+  }
+  return bounds;
+}
+
+auto PairwiseSum(std::vector<double>& values) -> double {
+  for (auto stride = config::Size{1}; stride < values.size(); stride *= 2) {
+    for (auto g = config::Index{0}; g + stride < values.size();
+         g += 2 * stride) {
+      values[g] += values[g + stride];
+    }
+  }
+  return values.empty() ? 0.0 : values[0];
+}
+
+auto GroupByLabel(const std::vector<config::Index>& labels, config::Size k)
+    -> ByLabel {
+  auto result = ByLabel{};
+  result.offsets.assign(k + 1, 0);
+  result.rows.resize(labels.size());
+
+  for (auto label : labels) {
+    ++result.offsets[label + 1];
+  }
+  for (auto c = config::Index{0}; c < k; ++c) {
+    result.offsets[c + 1] += result.offsets[c];
+  }
+
+  auto next = result.offsets;
+  for (auto i = config::Index{0}; i < labels.size(); ++i) {
+    result.rows[next[labels[i]]++] = i;
+  }
+
+  return result;
+}
+
+}  // namespace reduction
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto FixedSums::Accumulate(const Points& points, Clusters& clusters)
+    -> double {
+  const auto k = clusters.size();
+  const auto bounds = reduction::GroupBounds(points.size());
+  const auto groups = bounds.size() - 1;
+
+  sums_.assign(groups * 3 * k, 0);
+  auto inertia = std::vector<double>(groups, 0);
+
+  parallel::ForChunks(groups, [&](config::Index g) {
+    TRACE_WORK();
+    auto* sums = &sums_[g * 3 * k];
+    auto loss = 0.0;
+
+    for (auto p = bounds[g]; p < bounds[g + 1]; ++p) {
+      const auto& point = points[p];
+      const auto& centroid = clusters[point.cluster_index].Centroid();
+      auto* sum = &sums[3 * point.cluster_index];
+
+      sum[0] += point.weight * point.x;
+      sum[1] += point.weight * point.y;
+      sum[2] += point.weight;
+
+      auto dx = point.x - centroid.x;
+      auto dy = point.y - centroid.y;
+      loss += dx * dx + dy * dy;
+    }
+
+    inertia[g] = loss;
+  });
+
+  // The pairwise tree of `PairwiseSum` over every coordinate of every
+  // cluster, clusters in parallel.
+  parallel::ForChunks(k, [&](config::Index c) {
+    auto column = std::vector<double>(groups);
+    auto total = std::array<double, 3>{};
+    for (auto j = config::Index{0}; j < 3; ++j) {
+      for (auto g = config::Index{0}; g < groups; ++g) {
+        column[g] = sums_[(g * k + c) * 3 + j];
+      }
+      total[j] = reduction::PairwiseSum(column);
+    }
+
+    auto sum = Point{};
+    sum.x = total[0];
+    sum.y = total[1];
+    clusters[c].SetPending(sum, total[2]);
+  });
+
+  return reduction::PairwiseSum(inertia);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "config.hpp"
+#include "cluster.hpp"
+#include "parallel.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Reductions of a fixed shape, for `Params::deterministic`: floating-point
+// sums are taken in an order that depends on the data only, never on the
+// thread count or the schedule, so results are bit-identical across both.
+namespace reduction {
+
+// Points are summed in at most that many groups of consecutive blocks of
+// `config::kBlockSize` points, sequentially within every group. Groups are
+// then added up pairwise in a fixed tree.
+constexpr auto kGroups = config::Size{64};
+
+// Groups of `n` points, group `g` is `[bounds[g], bounds[g + 1])`.
+auto GroupBounds(config::Size n) -> std::vector<config::Index>;
+
+// Adds `values[g]` up pairwise, `values` is clobbered.
+auto PairwiseSum(std::vector<double>& values) -> double;
+
+// Sum of `term(i)` over `[0, n)` in the fixed shape above.
+template <typename Term>
+auto Sum(config::Size n, Term term) -> double {
+  const auto bounds = GroupBounds(n);
+  auto sums = std::vector<double>(bounds.size() - 1, 0);
+
+  parallel::ForChunks(sums.size(), [&](config::Index g) {
+    auto sum = 0.0;
+    for (auto i = bounds[g]; i < bounds[g + 1]; ++i) {
+      sum += term(i);
+    }
+    sums[g] = sum;
+  });
+
+  return PairwiseSum(sums);
+}
+
+// Rows `0..labels.size()` grouped by label in increasing order, row `i` of
+// label `c` being `rows[offsets[c] + i]`. Summing them cluster by cluster
+// in that order is of a fixed shape too.
+struct ByLabel {
+  std::vector<config::Index> offsets;  // `k + 1` of them
+  std::vector<config::Index> rows;
+};
+
+auto GroupByLabel(const std::vector<config::Index>& labels, config::Size k)
+    -> ByLabel;
+
+}  // namespace reduction
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Sums of clusters over the groups of `reduction::kGroups`, replacing those
+// accumulated by the atomics of `Cluster::Add`.
+class FixedSums {
+ public:
+  // Sets pending sums of `clusters` to the (weighted) sums of `points` by
+  // `cluster_index`. Returns the inertia of points against the current
+  // centroids, summed in the same shape.
+  auto Accumulate(const Points& points, Clusters& clusters) -> double;
+
+ private:
+  std::vector<double> sums_;  // a row of `x, y, weight` per group and cluster
+};
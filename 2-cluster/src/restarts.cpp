@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "restarts.hpp"
+#include "engine.hpp"
+#include "io.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+RestartSolver::RestartSolver(Params params) : params_(params) {
+  if (params_.mode != Mode::kLloyd) {
+    throw std::invalid_argument("Restarts run lloyd engine only");
+  }
+  if (params_.restarts == 0) {
+    throw std::invalid_argument("At least one restart is required");
+  }
+}
+
+auto RestartSolver::Solve(const std::string& input, const std::string& output)
+    -> void {
+  Read(input);
+
+  report_ = {};
+
+  auto start = config::Clock::now();
+  ChooseCentroids();
+  report_.seeding =
+      std::chrono::duration_cast<config::Mcs>(config::Clock::now() - start);
+
+  while (Step()) {
+  }
+
+  auto best = config::Index{0};
+  for (auto r = config::Index{0}; r < params_.restarts; ++r) {
+    report_.restart_inertia.push_back(ComputeInertia(r));
+    if (report_.restart_inertia[r] < report_.restart_inertia[best]) {
+      best = r;
+    }
+  }
+  report_.inertia = report_.restart_inertia[best];
+  report_.stop_reason = convergence_[best].Reason();
+
+  Write(output, best);
+}
+
+auto RestartSolver::LastReport() const -> const Report& {
+  return report_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto RestartSolver::Read(const std::string& input) -> void {
+  auto cluster_count = ReadDataset(input, points_);
+
+  clusters_.assign(params_.restarts, Clusters(cluster_count));
+  centroids_.assign(params_.restarts, Centroids{});
+  labels_.assign(params_.restarts,
+                 std::vector<config::Index>(points_.size(), 0));
+}
+
+auto RestartSolver::ChooseCentroids() -> void {
+  active_.clear();
+  convergence_.assign(params_.restarts,
+                      Convergence{params_.stop, points_.size()});
+
+  for (auto r = config::Index{0}; r < params_.restarts; ++r) {
+    ::ChooseCentroids(params_.seeding, points_, clusters_[r],
+                      params_.seed + r);
+    active_.push_back(r);
+  }
+}
+
+auto RestartSolver::Step() -> bool {
+  stats_.assign(params_.restarts, StepStats{});
+  for (auto r : active_) {
+    centroids_[r].Load(clusters_[r]);
+  }
+
+  auto block_count =
+      (points_.size() + config::kBlockSize - 1) / config::kBlockSize;
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(runtime)
+  for (auto b = config::Index{0}; b < block_count; ++b) {
+    AssignBlock(b * config::kBlockSize,
+                std::min(points_.size(), (b + 1) * config::kBlockSize));
+  }
+
+  auto k = clusters_.front().size();
+  auto total = StepStats{};
+
+  auto moving = std::vector<config::Index>{};
+  for (auto r : active_) {
+    stats_[r].computed = points_.size() * k;
+    total += stats_[r];
+
+    auto moved = UpdateClusters(clusters_[r]);
+    if (!convergence_[r].Done(stats_[r], moved)) {
+      moving.push_back(r);
+    }
+  }
+
+  report_.history.push_back(total);
+  active_ = std::move(moving);
+  return !active_.empty();
+}
+
+auto RestartSolver::AssignBlock(config::Index first, config::Index last)
+    -> void {
+  for (auto r : active_) {
+    kernels::AssignNearest(centroids_[r], &points_[first], last - first);
+
+    auto& labels = labels_[r];
+    auto& clusters = clusters_[r];
+    auto changed = config::Size{0};
+    auto inertia = 0.0;
+    for (auto p = first; p < last; ++p) {
+      if (labels[p] != points_[p].cluster_index) {
+        ++changed;
+      }
+      labels[p] = points_[p].cluster_index;
+      clusters[labels[p]].Add(points_[p]);
+
+      // Centroids only move in `UpdateClusters`.
+      const auto& centroid = clusters[labels[p]].Centroid();
+      auto dx = points_[p].x - centroid.x;
+      auto dy = points_[p].y - centroid.y;
+      inertia += dx * dx + dy * dy;
+    }
+
+#pragma omp atomic
+    stats_[r].changed += changed;
+#pragma omp atomic
+    stats_[r].inertia += inertia;
+  }
+}
+
+// Same as `Solver::ComputeInertia`: against the centroids being returned.
+auto RestartSolver::ComputeInertia(config::Index restart) const -> double {
+  const auto& labels = labels_[restart];
+  const auto& clusters = clusters_[restart];
+  auto inertia = 0.0;
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static) reduction(+:inertia)
+  for (auto p = config::Index{0}; p < points_.size(); ++p) {
+    const auto& centroid = clusters[labels[p]].Centroid();
+    auto dx = points_[p].x - centroid.x;
+    auto dy = points_[p].y - centroid.y;
+    inertia += dx * dx + dy * dy;
+  }
+
+  return inertia;
+}
+
+auto RestartSolver::Write(const std::string& output, config::Index restart)
+    -> void {
+  for (auto p = config::Index{0}; p < points_.size(); ++p) {
+    points_[p].cluster_index = labels_[restart][p];
+  }
+
+  WriteResult(output, clusters_[restart], points_);
+}
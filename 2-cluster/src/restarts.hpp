@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+#include "cluster.hpp"
+#include "convergence.hpp"
+#include "kernels.hpp"
+#include "params.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Runs `Params::restarts` independently seeded Lloyd restarts on a dataset
+// loaded once and keeps the one with the lowest inertia.
+// Restarts run in lockstep: every block of points is assigned against the
+// centroids of all restarts still moving before the next block is touched,
+// so points are streamed through cache once per iteration, not per restart.
+// Restart `r` is seeded with `Params::seed + r` (random seeding keeps
+// drawing from `std::rand()`, so restart 0 matches a single run), and stops
+// by `Params::stop` on its own.
+class RestartSolver {
+ public:
+  explicit RestartSolver(Params params);
+
+  auto Solve(const std::string& input, const std::string& output) -> void;
+
+  // `history` sums statistics of all restarts per lockstep iteration,
+  // `inertia` is the best of `restart_inertia` and `stop_reason` is that of
+  // the best restart.
+  auto LastReport() const -> const Report&;
+
+ private:
+  auto Read(const std::string& input) -> void;
+
+  auto ChooseCentroids() -> void;
+
+  // One iteration of every active restart.
+  // Returns whether any restart is still active.
+  auto Step() -> bool;
+
+  // Adds changes and inertia of every active restart to `stats_`.
+  auto AssignBlock(config::Index first, config::Index last) -> void;
+
+  auto ComputeInertia(config::Index restart) const -> double;
+
+  auto Write(const std::string& output, config::Index restart) -> void;
+
+ private:
+  Params params_;
+  Report report_;
+
+  Points points_;
+  std::vector<Clusters> clusters_;
+  std::vector<Centroids> centroids_;
+  std::vector<std::vector<config::Index>> labels_;
+  std::vector<config::Index> active_;  // restarts which haven't stopped
+  std::vector<Convergence> convergence_;
+  std::vector<StepStats> stats_;  // of the current iteration
+};
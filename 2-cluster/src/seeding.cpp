@@ -0,0 +1,390 @@
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "seeding.hpp"
+#include "random.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr auto kInf = std::numeric_limits<double>::infinity();
+
+// Points sharing one random generator and one partial sum.
+constexpr auto kSeedBlock = config::Size{4096};
+
+constexpr auto kParallelRounds = std::uint64_t{5};
+constexpr auto kOversampling = config::Size{2};
+constexpr auto kReclusterIterations = 5;
+
+auto Distance2(const Point& a, const Point& b) -> double {
+  auto dx = a.x - b.x;
+  auto dy = a.y - b.y;
+  return dx * dx + dy * dy;
+}
+
+auto BlockCount(config::Size n) -> config::Size {
+  return (n + kSeedBlock - 1) / kSeedBlock;
+}
+
+// Whether any point weighs other than 1, as coreset points do.
+auto Weighted(const Points& points) -> bool {
+  return std::any_of(points.begin(), points.end(), [](const Point& p) {
+    return p.weight != 1;
+  });
+}
+
+// Index below `n` drawn with probability proportional to `weight(i)`,
+// `uniform` being in [0, 1).
+template <typename Weight>
+auto DrawByWeight(config::Size n, Weight weight, double uniform)
+    -> config::Index {
+  auto total = 0.0;
+  for (auto i = config::Index{0}; i < n; ++i) {
+    total += weight(i);
+  }
+
+  auto target = uniform * total;
+  auto i = config::Index{0};
+  for (; i + 1 < n; ++i) {
+    if (target < weight(i)) {
+      break;
+    }
+    target -= weight(i);
+  }
+  return i;
+}
+
+// Squared distance of every point to its closest chosen centroid,
+// along with per-block sums of `weight * distance`. Points weigh
+// `Point::weight` unless `weights` are given.
+class Distances {
+ public:
+  Distances(const Points& points, const std::vector<double>* weights)
+      : weights_(weights != nullptr ? *weights
+                                    : std::vector<double>(points.size())),
+        x_(points.size()),
+        y_(points.size()),
+        dist_(points.size(), kInf),
+        nearest_(points.size(), 0),
+        block_sums_(BlockCount(points.size()), 0) {
+    for (auto i = config::Index{0}; i < points.size(); ++i) {
+      x_[i] = points[i].x;
+      y_[i] = points[i].y;
+      if (weights == nullptr) {
+        weights_[i] = points[i].weight;
+      }
+    }
+  }
+
+  // Takes `centroids[first, last)` into account.
+  auto Update(const Points& centroids, config::Index first,
+              config::Index last) -> double {
+    const auto n = x_.size();
+    const auto blocks = block_sums_.size();
+
+    auto cx = std::vector<double>{};
+    auto cy = std::vector<double>{};
+    for (auto c = first; c < last; ++c) {
+      cx.push_back(centroids[c].x);
+      cy.push_back(centroids[c].y);
+    }
+
+    // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static) if (n > kSeedBlock)
+    for (auto b = config::Index{0}; b < blocks; ++b) {
+      auto sum = 0.0;
+
+      for (auto i = b * kSeedBlock; i < std::min(n, (b + 1) * kSeedBlock);
+           ++i) {
+        const auto px = x_[i];
+        const auto py = y_[i];
+
+        for (auto c = config::Index{0}; c < cx.size(); ++c) {
+          auto dx = px - cx[c];
+          auto dy = py - cy[c];
+          if (auto d = dx * dx + dy * dy; d < dist_[i]) {
+            dist_[i] = d;
+            nearest_[i] = first + c;
+          }
+        }
+        sum += Weight(i) * dist_[i];
+      }
+
+      block_sums_[b] = sum;
+    }
+
+    auto total = 0.0;
+    for (auto s : block_sums_) {
+      total += s;
+    }
+    return total;
+  }
+
+  // Samples a point with probability proportional to `weight * distance`,
+  // `target` is uniform in [0, total).
+  auto Sample(double target) const -> config::Index {
+    auto b = config::Index{0};
+    while (b + 1 < block_sums_.size() && target >= block_sums_[b]) {
+      target -= block_sums_[b++];
+    }
+
+    auto last = std::min(x_.size(), (b + 1) * kSeedBlock);
+    for (auto i = b * kSeedBlock; i < last; ++i) {
+      auto w = Weight(i) * dist_[i];
+      if (w > 0 && target < w) {
+        return i;
+      }
+      target -= w;
+    }
+
+    // Rounding left `target` past the last point with positive weight.
+    for (auto i = last; i-- > b * kSeedBlock;) {
+      if (Weight(i) * dist_[i] > 0) {
+        return i;
+      }
+    }
+    return b * kSeedBlock;
+  }
+
+  auto Weight(config::Index i) const -> double {
+    return weights_[i];
+  }
+
+  auto Dist(config::Index i) const -> double {
+    return dist_[i];
+  }
+
+  auto Nearest(config::Index i) const -> config::Index {
+    return nearest_[i];
+  }
+
+ private:
+  std::vector<double> weights_;
+  std::vector<double> x_;  // coordinates copied out of the wide `Point`s
+  std::vector<double> y_;
+  std::vector<double> dist_;
+  std::vector<config::Index> nearest_;
+  std::vector<double> block_sums_;
+};
+
+// Weighted k-means++ over `points`, `weights` may be null to use those of
+// the points themselves. The first centroid is drawn by weight too.
+auto PlusPlus(const Points& points, const std::vector<double>* weights,
+              config::Size k, Random& random) -> Points {
+  auto dist = Distances{points, weights};
+  auto chosen = Points{};
+  chosen.reserve(k);
+
+  // Unit weights keep the uniform draw, and so the centroids seeded before.
+  auto first = random.Below(points.size());
+  if (weights != nullptr || Weighted(points)) {
+    first = DrawByWeight(
+        points.size(), [&](config::Index i) { return dist.Weight(i); },
+        random.Uniform());
+  }
+  chosen.push_back(points[first]);
+
+  while (chosen.size() < k) {
+    auto total = dist.Update(chosen, chosen.size() - 1, chosen.size());
+
+    // Every point coincides with a chosen centroid already.
+    auto next = total > 0 ? dist.Sample(random.Uniform() * total)
+                          : random.Below(points.size());
+    chosen.push_back(points[next]);
+  }
+
+  return chosen;
+}
+
+// Weighted Lloyd iterations over a small set of points, sequential.
+auto Refine(const Points& points, const std::vector<double>& weights,
+            Points& centroids) -> void {
+  const auto k = centroids.size();
+
+  for (auto it = 0; it < kReclusterIterations; ++it) {
+    auto sums = std::vector<double>(2 * k, 0);
+    auto total = std::vector<double>(k, 0);
+
+    for (auto i = config::Index{0}; i < points.size(); ++i) {
+      auto nearest = config::Index{0};
+      auto min_dist = kInf;
+      for (auto c = config::Index{0}; c < k; ++c) {
+        if (auto d = Distance2(points[i], centroids[c]); d < min_dist) {
+          nearest = c;
+          min_dist = d;
+        }
+      }
+
+      sums[2 * nearest] += weights[i] * points[i].x;
+      sums[2 * nearest + 1] += weights[i] * points[i].y;
+      total[nearest] += weights[i];
+    }
+
+    for (auto c = config::Index{0}; c < k; ++c) {
+      if (total[c] > 0) {
+        centroids[c].x = sums[2 * c] / total[c];
+        centroids[c].y = sums[2 * c + 1] / total[c];
+      }
+    }
+  }
+}
+
+auto Store(const Points& centroids, Clusters& clusters) -> void {
+  for (auto c = config::Index{0}; c < clusters.size(); ++c) {
+    clusters[c].Centroid() = centroids[c];
+  }
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto ParseSeeding(std::string_view name) -> Seeding {
+  if (name == "random") {
+    return Seeding::kRandom;
+  }
+  if (name == "kmeans++") {
+    return Seeding::kPlusPlus;
+  }
+  if (name == "kmeans||") {
+    return Seeding::kParallel;
+  }
+  throw std::invalid_argument("Unknown seeding: " + std::string{name});
+}
+
+auto ToString(Seeding seeding) -> std::string_view {
+  switch (seeding) {
+    case Seeding::kRandom:
+      return "random";
+    case Seeding::kPlusPlus:
+      return "kmeans++";
+    case Seeding::kParallel:
+      return "kmeans||";
+  }
+  return "unknown";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto ChooseCentroids(Seeding seeding, const Points& points, Clusters& clusters,
+                     std::uint64_t seed) -> void {
+  switch (seeding) {
+    case Seeding::kRandom:
+      SeedRandom(points, clusters);
+      break;
+    case Seeding::kPlusPlus:
+      SeedPlusPlus(points, clusters, seed);
+      break;
+    case Seeding::kParallel:
+      SeedParallel(points, clusters, seed);
+      break;
+  }
+}
+
+// Use of `rand()` here is intentional.
+// Serious randomness (via `mt19937`, for example) is not required.
+auto SeedRandom(const Points& points, Clusters& clusters) -> void {
+  auto used = std::unordered_set<config::Index>{};
+
+  // Weighted points are drawn by weight from prefix sums.
+  auto prefix = Weighted(points) ? std::vector<double>(points.size())
+                                  : std::vector<double>{};
+  auto total = 0.0;
+  for (auto p = config::Index{0}; p < prefix.size(); ++p) {
+    prefix[p] = total += points[p].weight;
+  }
+
+  while (used.size() < clusters.size()) {
+    auto p = static_cast<config::Index>(std::rand());
+    if (prefix.empty()) {
+      p %= points.size();
+    } else {
+      auto target = static_cast<double>(p) /
+                    (static_cast<double>(RAND_MAX) + 1) * prefix.back();
+      auto it = std::upper_bound(prefix.begin(), prefix.end(), target);
+      p = std::min(static_cast<config::Index>(it - prefix.begin()),
+                   points.size() - 1);
+    }
+    if (used.find(p) != std::end(used)) {
+      continue;
+    }
+
+    clusters[used.size()].Centroid() = points[p];
+    used.insert(p);
+  }
+}
+
+auto SeedPlusPlus(const Points& points, Clusters& clusters, std::uint64_t seed)
+    -> void {
+  auto random = Random{seed};
+  Store(PlusPlus(points, nullptr, clusters.size(), random), clusters);
+}
+
+auto SeedParallel(const Points& points, Clusters& clusters, std::uint64_t seed)
+    -> void {
+  const auto n = points.size();
+  const auto k = clusters.size();
+  const auto blocks = BlockCount(n);
+  const auto oversampling = static_cast<double>(kOversampling * k);
+
+  auto random = Random{seed};
+  auto initial = random.Below(n);
+  if (Weighted(points)) {
+    initial = DrawByWeight(
+        n, [&](config::Index i) { return points[i].weight; },
+        random.Uniform());
+  }
+  auto candidates = Points{points[initial]};
+
+  auto dist = Distances{points, nullptr};
+  auto potential = dist.Update(candidates, 0, 1);
+
+  for (auto round = std::uint64_t{1}; round <= kParallelRounds; ++round) {
+    if (potential == 0) {
+      break;
+    }
+
+    auto sampled = std::vector<std::vector<config::Index>>(blocks);
+
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+    for (auto b = config::Index{0}; b < blocks; ++b) {
+      auto local = Random{seed, round, b};
+      for (auto i = b * kSeedBlock; i < std::min(n, (b + 1) * kSeedBlock);
+           ++i) {
+        if (local.Uniform() * potential <
+            oversampling * dist.Weight(i) * dist.Dist(i)) {
+          sampled[b].push_back(i);
+        }
+      }
+    }
+
+    auto first = candidates.size();
+    for (const auto& block : sampled) {
+      for (auto i : block) {
+        candidates.push_back(points[i]);
+      }
+    }
+
+    potential = dist.Update(candidates, first, candidates.size());
+  }
+
+  if (candidates.size() <= k) {
+    SeedPlusPlus(points, clusters, seed);
+    return;
+  }
+
+  auto weights = std::vector<double>(candidates.size(), 0);
+  for (auto i = config::Index{0}; i < n; ++i) {
+    weights[dist.Nearest(i)] += points[i].weight;
+  }
+
+  auto centroids = PlusPlus(candidates, &weights, k, random);
+  Refine(candidates, weights, centroids);
+  Store(centroids, clusters);
+}
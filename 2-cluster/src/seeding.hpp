@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "config.hpp"
+#include "cluster.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+enum class Seeding {
+  kRandom,
+  kPlusPlus,
+  kParallel,
+};
+
+auto ParseSeeding(std::string_view name) -> Seeding;
+auto ToString(Seeding seeding) -> std::string_view;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Picks initial centroids of all `clusters` among `points`.
+auto ChooseCentroids(Seeding seeding, const Points& points, Clusters& clusters,
+                     std::uint64_t seed) -> void;
+
+// Distinct random points drawn from `std::rand()`, uniformly unless points
+// are weighted, see `Point::weight`.
+auto SeedRandom(const Points& points, Clusters& clusters) -> void;
+
+// Both seedings below are reproducible from `seed` alone: random numbers
+// are drawn from generators bound to fixed blocks of points rather than to
+// threads, and all sums are taken in block order, so the chosen centroids
+// do not depend on the thread count.
+
+// k-means++ (Arthur and Vassilvitskii, 2007): every next centroid is a point
+// sampled with probability proportional to its squared distance (D^2) to the
+// closest centroid chosen so far.
+auto SeedPlusPlus(const Points& points, Clusters& clusters, std::uint64_t seed)
+    -> void;
+
+// k-means|| (Bahmani et al., 2012): a few rounds sample `2k` points each in
+// parallel with D^2 probabilities, the oversampled candidates are weighted by
+// the number of points closest to them and reclustered down to `k` with
+// weighted k-means++ followed by a few weighted Lloyd iterations.
+auto SeedParallel(const Points& points, Clusters& clusters, std::uint64_t seed)
+    -> void;
@@ -1,102 +1,364 @@
-#include <cstdlib>
-#include <fstream>
-#include <unordered_set>
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
 
 #include "solver.hpp"
+#include "bisecting.hpp"
+#include "coreset.hpp"
+#include "dbscan.hpp"
+#include "dense.hpp"
+#include "distributed.hpp"
+#include "io.hpp"
+#include "kernels.hpp"
+#include "numa.hpp"
+#include "reduction.hpp"
+#include "restarts.hpp"
+#include "sparse.hpp"
+#include "streaming.hpp"
+#include "trace.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
 
+Solver::Solver(Params params) : params_(params) {
+}
+
 auto Solver::Solve(const std::string& input, const std::string& output)
     -> void {
+  TRACE_RUN(input);
+
+  // Only in-memory 2D runs leave a model behind, bisecting ones a tree.
+  points_.clear();
+  clusters_.clear();
+  tree_ = {};
+
+  if (params_.order != Order::kNone &&
+      (params_.distributed || params_.restarts > 1 ||
+       params_.chunk_size != 0)) {
+    throw std::invalid_argument("Reordering supports in-memory runs only");
+  }
+  if (params_.coreset_size != 0 &&
+      (params_.distributed || params_.restarts > 1 ||
+       params_.chunk_size != 0)) {
+    throw std::invalid_argument("Coresets support in-memory runs only");
+  }
+  if (params_.deterministic &&
+      (params_.distributed || params_.restarts > 1 ||
+       params_.chunk_size != 0)) {
+    throw std::invalid_argument("Deterministic sums need in-memory runs");
+  }
+  if ((!params_.warm_start.empty() || !params_.checkpoint.empty()) &&
+      (params_.distributed || params_.restarts > 1 ||
+       params_.chunk_size != 0 || params_.mode == Mode::kDbscan ||
+       params_.mode == Mode::kBisecting || params_.mode == Mode::kGemm ||
+       params_.precision != Precision::kDouble ||
+       ReadHeader(input).sparse || ReadHeader(input).dimension != 2)) {
+    throw std::invalid_argument(
+        "Warm starts and checkpoints support in-memory 2D runs only");
+  }
+  if (!params_.checkpoint.empty() && params_.checkpoint_every == 0) {
+    throw std::invalid_argument("Checkpoint interval must be positive");
+  }
+
+  if (ReadHeader(input).sparse) {
+    if (params_.distributed || params_.restarts > 1 ||
+        params_.chunk_size != 0 || params_.coreset_size != 0 ||
+        params_.order != Order::kNone ||
+        params_.precision != Precision::kDouble) {
+      throw std::invalid_argument(
+          "Sparse datasets support in-memory runs only");
+    }
+
+    auto sparse = SparseSolver{params_};
+    sparse.Solve(input, output);
+    report_ = sparse.LastReport();
+    return;
+  }
+
+  if (params_.mode == Mode::kDbscan || params_.mode == Mode::kBisecting) {
+    if (params_.distributed || params_.restarts > 1 ||
+        params_.chunk_size != 0 || params_.coreset_size != 0 ||
+        params_.order != Order::kNone ||
+        params_.precision != Precision::kDouble ||
+        ReadHeader(input).dimension != 2) {
+      throw std::invalid_argument(std::string{ToString(params_.mode)} +
+                                  " supports in-memory 2D runs only");
+    }
+  }
+
+  if (params_.mode == Mode::kDbscan) {
+    auto dbscan = DbscanSolver{params_};
+    dbscan.Solve(input, output);
+    report_ = dbscan.LastReport();
+    return;
+  }
+
+  if (params_.mode == Mode::kBisecting) {
+    auto bisecting = BisectingSolver{params_};
+    bisecting.Solve(input, output);
+    report_ = bisecting.LastReport();
+    tree_ = bisecting.LastTree();
+    return;
+  }
+
+  if (params_.distributed) {
+    if (params_.chunk_size != 0) {
+      throw std::invalid_argument("Streaming mode can't be distributed");
+    }
+    if (params_.precision != Precision::kDouble) {
+      throw std::invalid_argument("Distributed mode is double precision only");
+    }
+
+    auto distributed = DistributedSolver{params_};
+    distributed.Solve(input, output);
+    report_ = distributed.LastReport();
+    return;
+  }
+
+  if (ReadHeader(input).dimension != 2 || params_.mode == Mode::kGemm ||
+      params_.precision != Precision::kDouble) {
+    if (params_.chunk_size != 0) {
+      throw std::invalid_argument("Streaming mode supports 2D points only");
+    }
+
+    auto dense = DenseSolver{params_};
+    dense.Solve(input, output);
+    report_ = dense.LastReport();
+    return;
+  }
+
+  if (params_.restarts > 1) {
+    auto restarts = RestartSolver{params_};
+    restarts.Solve(input, output);
+    report_ = restarts.LastReport();
+    return;
+  }
+
+  if (params_.chunk_size != 0) {
+    auto streaming = StreamingSolver{params_};
+    streaming.Solve(input, output);
+    report_ = streaming.LastReport();
+    return;
+  }
+
+  report_ = {};
+
+  auto start = config::Clock::now();
   Read(input);
+  report_.read = config::Since(start);
+
+  resume_ = {};
+  resume_.seed = params_.seed;
+  if (!params_.warm_start.empty()) {
+    resume_ = ReadCheckpoint(params_.warm_start, params_.seed);
+    report_.resumed = resume_.iteration;
+  }
+
+  start = config::Clock::now();
+  Summarize();
+  report_.coreset = config::Since(start);
+
+  start = config::Clock::now();
+  ChooseCentroids();
+  report_.seeding = config::Since(start);
 
-  ChooseRandomCentroids();
+  // After seeding, so initial centroids don't depend on the layout.
+  start = config::Clock::now();
+  Reorder();
+  report_.reorder = config::Since(start);
 
-  auto updated = true;
-  while (updated) {
-    updated = Step();
+  auto engine = MakeEngine(params_.mode, points_, clusters_);
+
+  auto convergence =
+      Convergence{params_.stop, points_.size(), resume_.iteration};
+  auto sums = FixedSums{};
+
+  auto writer = std::optional<CheckpointWriter>{};
+  if (!params_.checkpoint.empty()) {
+    writer.emplace(params_.checkpoint);
   }
 
+  auto done = false;
+  while (!done) {
+    start = config::Clock::now();
+    TRACE_BEGIN("assign");
+    engine->Assign();
+    TRACE_END();
+    auto stats = engine->LastStats();
+    if (params_.deterministic) {
+      // Labels don't depend on threads, atomically added sums do.
+      TRACE_BEGIN("reduce");
+      stats.inertia = sums.Accumulate(points_, clusters_);
+      TRACE_END();
+    }
+    report_.assign += config::Since(start);
+
+    start = config::Clock::now();
+    TRACE_BEGIN("update");
+    auto moved = engine->Update();
+    TRACE_END();
+    report_.update += config::Since(start);
+
+    TRACE_ITERATION(stats);
+    report_.history.push_back(stats);
+    done = convergence.Done(report_.history.back(), moved);
+
+    auto iteration = resume_.iteration + report_.history.size();
+    if (writer && (done || iteration % params_.checkpoint_every == 0)) {
+      auto checkpoint = Checkpoint{iteration, resume_.seed, {}};
+      checkpoint.centroids.reserve(clusters_.size());
+      for (const auto& c : clusters_) {
+        checkpoint.centroids.push_back(c.Centroid());
+      }
+      writer->Save(std::move(checkpoint));
+    }
+  }
+
+  report_.stop_reason = convergence.Reason();
+  if (writer) {
+    writer->Flush();
+  }
+
+  start = config::Clock::now();
+  Expand();
+  report_.assign += config::Since(start);
+
+  report_.placement = numa::Placement(points_.data());
+
+  report_.inertia = ComputeInertia();
+
+  start = config::Clock::now();
   Write(output);
+  report_.write = config::Since(start);
 }
 
-////////////////////////////////////////////////////////////////////////////////
+auto Solver::LastReport() const -> const Report& {
+  return report_;
+}
 
-auto Solver::Read(const std::string& input) -> void {
-  auto in = std::ifstream{input};
+auto Solver::LastModel(bool indexed) const -> Model {
+  if (points_.empty()) {
+    throw std::runtime_error("No model kept by the last run");
+  }
 
-  auto point_count = config::Size{0};
-  auto cluster_count = config::Size{0};
+  auto weights = std::vector<double>(clusters_.size(), 0);
 
-  in >> point_count >> cluster_count;
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto p = config::Index{0}; p < points_.size(); ++p) {
+#pragma omp atomic
+    weights[points_[p].cluster_index] += points_[p].weight;
+  }
 
-  assert(point_count > 0);
-  assert(cluster_count > 0);
+  return Model{clusters_, std::move(weights), indexed};
+}
 
-  points_.resize(point_count);
-  for (auto& p : points_) {
-    in >> p;
+auto Solver::LastTree() const -> const ClusterTree& {
+  if (tree_.nodes.empty()) {
+    throw std::runtime_error("No tree kept by the last run");
   }
+  return tree_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
 
-  clusters_.resize(cluster_count);
+auto Solver::Read(const std::string& input) -> void {
+  clusters_.resize(ReadDataset(input, points_));
 }
 
-// Use of `rand()` here is intentional.
-// Serious randomness (via `mt19937`, for example) is not required.
-auto Solver::ChooseRandomCentroids() -> void {
-  auto used = std::unordered_set<config::Index>{};
+auto Solver::Summarize() -> void {
+  summarized_.clear();
+  if (params_.coreset_size == 0 || params_.coreset_size >= points_.size()) {
+    return;
+  }
+  if (params_.coreset_size < clusters_.size()) {
+    throw std::invalid_argument("Coreset smaller than the number of clusters");
+  }
 
-  while (used.size() < clusters_.size()) {
-    auto p = static_cast<config::Index>(std::rand()) % points_.size();
-    if (used.find(p) != std::end(used)) {
-      continue;
-    }
+  summarized_ = std::exchange(
+      points_, BuildCoreset(points_, params_.coreset_size, resume_.seed));
+}
 
-    clusters_[used.size()].Centroid() = points_[p];
-    used.insert(p);
+auto Solver::ChooseCentroids() -> void {
+  if (params_.warm_start.empty()) {
+    ::ChooseCentroids(params_.seeding, points_, clusters_, params_.seed);
+    return;
+  }
+
+  if (resume_.centroids.size() != clusters_.size()) {
+    throw std::invalid_argument(
+        params_.warm_start + " holds " +
+        std::to_string(resume_.centroids.size()) + " centroids, not " +
+        std::to_string(clusters_.size()));
+  }
+  for (auto c = config::Index{0}; c < clusters_.size(); ++c) {
+    clusters_[c].Centroid() = resume_.centroids[c];
   }
 }
 
-auto Solver::Step() -> bool {
-#pragma omp parallel for num_threads(config::kThreadCount) schedule(guided)
-  for (auto p = config::Index{0}; p < points_.size(); ++p) {
-    Assign(points_[p]);
+auto Solver::Expand() -> void {
+  if (summarized_.empty()) {
+    return;
   }
 
-  auto updated = false;
+  // Labels of the coreset refer to its own order.
+  permutation_.clear();
+  points_ = std::move(summarized_);
+  summarized_ = {};
+
+  auto centroids = Centroids{};
+  centroids.Load(clusters_);
+
+  const auto n = points_.size();
+  const auto blocks = (n + config::kBlockSize - 1) / config::kBlockSize;
 
   // NOLINTNEXTLINE
-#pragma omp parallel for num_threads(config::kThreadCount) schedule(guided) reduction(|:updated)
-  for (auto c = config::Index{0}; c < clusters_.size(); ++c) {
-    updated |= clusters_[c].Update();
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(runtime)
+  for (auto b = config::Index{0}; b < blocks; ++b) {
+    auto first = b * config::kBlockSize;
+    kernels::AssignNearest(centroids, &points_[first],
+                           std::min(config::kBlockSize, n - first));
   }
-
-  return updated;
 }
 
-auto Solver::Assign(Point& p) -> void {
-  auto nearest = config::Index{0};
-  auto min_dist = clusters_[nearest].DistanceTo(p);
+// Centroids have been moved after the last assignment, so this is the
+// objective of the returned model rather than of the last `Step`.
+auto Solver::ComputeInertia() const -> double {
+  if (params_.deterministic) {
+    return reduction::Sum(points_.size(), [&](config::Index p) {
+      const auto& centroid = clusters_[points_[p].cluster_index].Centroid();
+      auto dx = points_[p].x - centroid.x;
+      auto dy = points_[p].y - centroid.y;
+      return dx * dx + dy * dy;
+    });
+  }
 
-  for (auto i = config::Index{0}; i < clusters_.size(); ++i) {
-    if (auto dist = clusters_[i].DistanceTo(p); dist < min_dist) {
-      nearest = i;
-      min_dist = dist;
-    }
+  auto inertia = 0.0;
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static) reduction(+:inertia)
+  for (auto p = config::Index{0}; p < points_.size(); ++p) {
+    const auto& centroid = clusters_[points_[p].cluster_index].Centroid();
+    auto dx = points_[p].x - centroid.x;
+    auto dy = points_[p].y - centroid.y;
+    inertia += dx * dx + dy * dy;
   }
 
-  p.cluster_index = nearest;
-  clusters_[nearest].Add(p);
+  return inertia;
 }
 
-auto Solver::Write(const std::string& output) -> void {
-  auto out = std::ofstream{output};
-
-  for (const auto& c : clusters_) {
-    out << c.Centroid() << '\n';
+auto Solver::Reorder() -> void {
+  permutation_.clear();
+  if (params_.order != Order::kNone) {
+    permutation_ = SortPoints(params_.order, points_);
   }
+}
 
-  for (const auto& p : points_) {
-    out << p.cluster_index << '\n';
+auto Solver::Write(const std::string& output) -> void {
+  if (!permutation_.empty()) {
+    RestoreOrder(permutation_, points_);
+    permutation_.clear();
   }
+  WriteResult(output, clusters_, points_);
 }
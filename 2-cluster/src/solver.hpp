@@ -1,24 +1,57 @@
 #pragma once
 
+#include <vector>
+
 #include "config.hpp"
+#include "bisecting.hpp"
+#include "checkpoint.hpp"
 #include "cluster.hpp"
+#include "model.hpp"
+#include "params.hpp"
 
 class Solver {
  public:
+  explicit Solver(Params params = {});
+
   auto Solve(const std::string& input, const std::string& output) -> void;
 
+  auto LastReport() const -> const Report&;
+
+  // Centroids of the last `Solve` weighted by the points assigned to them,
+  // to serve new points. In-memory 2D runs only.
+  auto LastModel(bool indexed = false) const -> Model;
+
+  // Tree of the last `Solve` with `Mode::kBisecting`, to label new points
+  // in `O(log k)`.
+  auto LastTree() const -> const ClusterTree&;
+
  private:
   auto Read(const std::string& input) -> void;
 
-  auto ChooseRandomCentroids() -> void;
+  // Replaces points by a coreset of `Params::coreset_size`, if any.
+  auto Summarize() -> void;
+
+  // Seeds, or starts from `Params::warm_start`.
+  auto ChooseCentroids() -> void;
 
-  auto Step() -> bool;
+  // Sorts points along the curve of `Params::order`, if any.
+  auto Reorder() -> void;
 
-  auto Assign(Point& p) -> void;
+  // Puts points back after `Summarize` and labels them all.
+  auto Expand() -> void;
+
+  auto ComputeInertia() const -> double;
 
   auto Write(const std::string& output) -> void;
 
  private:
   Points points_;
+  Points summarized_;  // all points while iterating on a coreset
   Clusters clusters_;
+  std::vector<config::Index> permutation_;  // of `Reorder`, if any
+  Checkpoint resume_;  // of `Params::warm_start`, if any
+  ClusterTree tree_;   // of bisecting runs only
+
+  Params params_;
+  Report report_;
 };
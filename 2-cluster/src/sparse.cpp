@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+
+#include "sparse.hpp"
+#include "io.hpp"
+#include "reduction.hpp"
+#include "trace.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+SparseSolver::SparseSolver(Params params) : params_(params) {
+  if (params_.mode != Mode::kLloyd && params_.mode != Mode::kSpherical) {
+    throw std::invalid_argument(
+        "Only lloyd and spherical engines support sparse datasets");
+  }
+  if (params_.seeding != Seeding::kRandom) {
+    throw std::invalid_argument(
+        "Only random seeding supports sparse datasets");
+  }
+}
+
+auto SparseSolver::Solve(const std::string& input, const std::string& output)
+    -> void {
+  report_ = {};
+
+  auto start = config::Clock::now();
+  auto data = ReadSparse(input);
+  if (params_.mode == Mode::kSpherical) {
+    Normalize(data);
+  }
+  report_.read = config::Since(start);
+
+  const auto n = data.header.point_count;
+  k_ = data.header.cluster_count;
+  dim_ = data.header.dimension;
+  labels_.assign(n, 0);
+
+  start = config::Clock::now();
+  ChooseCentroids(data);
+  report_.seeding = config::Since(start);
+
+  auto convergence = Convergence{params_.stop, n};
+
+  auto done = false;
+  while (!done) {
+    auto stats = StepStats{n * k_, 0};
+    auto moved = Step(data, stats);
+    TRACE_ITERATION(stats);
+    report_.history.push_back(stats);
+    done = convergence.Done(stats, moved);
+  }
+
+  report_.stop_reason = convergence.Reason();
+  report_.inertia = ComputeInertia(data);
+
+  start = config::Clock::now();
+  WriteResult(output, centroids_, dim_, labels_);
+  report_.write = config::Since(start);
+}
+
+auto SparseSolver::LastReport() const -> const Report& {
+  return report_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Rows of zeros stay as they are.
+auto SparseSolver::Normalize(SparseDataset& data) const -> void {
+  const auto n = data.header.point_count;
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto p = config::Index{0}; p < n; ++p) {
+    const auto first = data.row_starts[p];
+    const auto last = data.row_starts[p + 1];
+
+    auto norm = 0.0;
+    for (auto i = first; i < last; ++i) {
+      norm += data.values[i] * data.values[i];
+    }
+    if (norm > 0) {
+      norm = std::sqrt(norm);
+      for (auto i = first; i < last; ++i) {
+        data.values[i] /= norm;
+      }
+    }
+  }
+}
+
+// Use of `rand()` here is intentional, just like in 2D.
+auto SparseSolver::ChooseCentroids(const SparseDataset& data) -> void {
+  const auto n = data.header.point_count;
+  if (n < k_) {
+    throw std::invalid_argument("Fewer points than clusters");
+  }
+
+  auto used = std::unordered_set<config::Index>{};
+  centroids_.assign(k_ * dim_, 0);
+
+  while (used.size() < k_) {
+    auto p = static_cast<config::Index>(std::rand()) % n;
+    if (used.find(p) != std::end(used)) {
+      continue;
+    }
+
+    auto* centroid = &centroids_[used.size() * dim_];
+    for (auto i = data.row_starts[p]; i < data.row_starts[p + 1]; ++i) {
+      centroid[data.columns[i]] += data.values[i];
+    }
+    used.insert(p);
+  }
+}
+
+auto SparseSolver::Step(const SparseDataset& data, StepStats& stats)
+    -> bool {
+  const auto n = data.header.point_count;
+  const auto spherical = params_.mode == Mode::kSpherical;
+  const auto ranges = params_.deterministic
+                          ? reduction::kGroups
+                          : static_cast<config::Size>(config::ThreadCount());
+
+  Load();
+
+  auto losses = std::vector<double>(ranges, 0);
+  auto changed = config::Size{0};
+
+  auto start = config::Clock::now();
+  TRACE_BEGIN("assign");
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static) reduction(+:changed)
+  for (auto r = config::Index{0}; r < ranges; ++r) {
+    TRACE_WORK();
+    auto scores = std::vector<double>(k_);
+    auto loss = 0.0;
+
+    for (auto p = r * n / ranges; p < (r + 1) * n / ranges; ++p) {
+      auto c = Nearest(data, p, scores);
+      if (c != labels_[p]) {
+        ++changed;
+        labels_[p] = c;
+      }
+      loss += Loss(data, p, c);
+    }
+
+    losses[r] = loss;
+  }
+
+  stats.changed = changed;
+  stats.inertia = reduction::PairwiseSum(losses);
+
+  TRACE_END();
+  report_.assign += config::Since(start);
+  start = config::Clock::now();
+  TRACE_BEGIN("update");
+
+  // Every cluster sums its own rows, gathered in file order, into one dense
+  // scratch row per thread: memory stays `O(nnz + threads * d)` whatever
+  // `k`, and sums don't depend on the thread count.
+  const auto groups = reduction::GroupByLabel(labels_, k_);
+
+  auto updated = false;
+
+  // NOLINTNEXTLINE
+#pragma omp parallel num_threads(config::ThreadCount()) reduction(|:updated)
+  {
+    auto total = std::vector<double>(dim_, 0);
+
+#pragma omp for schedule(static)
+    for (auto c = config::Index{0}; c < k_; ++c) {
+      TRACE_WORK();
+      // Empty clusters keep their centroid.
+      auto size = groups.offsets[c + 1] - groups.offsets[c];
+      if (size == 0) {
+        continue;
+      }
+
+      for (auto g = groups.offsets[c]; g < groups.offsets[c + 1]; ++g) {
+        auto p = groups.rows[g];
+        for (auto i = data.row_starts[p]; i < data.row_starts[p + 1]; ++i) {
+          total[data.columns[i]] += data.values[i];
+        }
+      }
+
+      auto* centroid = &centroids_[c * dim_];
+      auto scale = 0.0;
+      for (auto d = config::Index{0}; d < dim_; ++d) {
+        scale += total[d] * total[d];
+      }
+
+      // Means, or sums scaled to unit length on the sphere.
+      scale = spherical ? (scale > 0 ? 1 / std::sqrt(scale) : 0)
+                        : 1 / static_cast<double>(size);
+
+      // Clears `total` for the next cluster on the way.
+      auto moved = 0.0;
+      for (auto d = config::Index{0}; d < dim_; ++d) {
+        auto value = scale * std::exchange(total[d], 0);
+        auto diff = value - centroid[d];
+        moved += diff * diff;
+        centroid[d] = value;
+      }
+
+      updated |= std::sqrt(moved) > 1e-6;
+    }
+  }
+
+  TRACE_END();
+  report_.update += config::Since(start);
+
+  return updated;
+}
+
+auto SparseSolver::Load() -> void {
+  transposed_.resize(dim_ * k_);
+  norms_.assign(k_, 0);
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static)
+  for (auto d = config::Index{0}; d < dim_; ++d) {
+    for (auto c = config::Index{0}; c < k_; ++c) {
+      transposed_[d * k_ + c] = centroids_[c * dim_ + d];
+    }
+  }
+
+  for (auto c = config::Index{0}; c < k_; ++c) {
+    for (auto d = config::Index{0}; d < dim_; ++d) {
+      norms_[c] += centroids_[c * dim_ + d] * centroids_[c * dim_ + d];
+    }
+  }
+}
+
+auto SparseSolver::Nearest(const SparseDataset& data, config::Index p,
+                           std::vector<double>& scores) const
+    -> config::Index {
+  std::fill(scores.begin(), scores.end(), 0.0);
+
+  for (auto i = data.row_starts[p]; i < data.row_starts[p + 1]; ++i) {
+    const auto value = data.values[i];
+    const auto* row = &transposed_[data.columns[i] * k_];
+    for (auto c = config::Index{0}; c < k_; ++c) {
+      scores[c] += value * row[c];
+    }
+  }
+
+  // Ties go to the lowest index, as everywhere else.
+  auto best = config::Index{0};
+  if (params_.mode == Mode::kSpherical) {
+    for (auto c = config::Index{1}; c < k_; ++c) {
+      if (scores[c] > scores[best]) {
+        best = c;
+      }
+    }
+  } else {
+    auto min_dist = norms_[0] - 2 * scores[0];
+    for (auto c = config::Index{1}; c < k_; ++c) {
+      if (auto d = norms_[c] - 2 * scores[c]; d < min_dist) {
+        best = c;
+        min_dist = d;
+      }
+    }
+  }
+
+  return best;
+}
+
+auto SparseSolver::Loss(const SparseDataset& data, config::Index p,
+                        config::Index c) const -> double {
+  const auto* centroid = &centroids_[c * dim_];
+
+  auto dot = 0.0;
+  auto norm = 0.0;
+  for (auto i = data.row_starts[p]; i < data.row_starts[p + 1]; ++i) {
+    dot += data.values[i] * centroid[data.columns[i]];
+    norm += data.values[i] * data.values[i];
+  }
+
+  if (params_.mode == Mode::kSpherical) {
+    return 1 - dot;
+  }
+  return std::max(0.0, norm - 2 * dot + norms_[c]);
+}
+
+auto SparseSolver::ComputeInertia(const SparseDataset& data) -> double {
+  const auto n = data.header.point_count;
+  auto inertia = 0.0;
+
+  Load();  // norms of the final centroids
+
+  if (params_.deterministic) {
+    return reduction::Sum(
+        n, [&](config::Index p) { return Loss(data, p, labels_[p]); });
+  }
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(static) reduction(+:inertia)
+  for (auto p = config::Index{0}; p < n; ++p) {
+    inertia += Loss(data, p, labels_[p]);
+  }
+
+  return inertia;
+}
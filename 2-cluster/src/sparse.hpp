@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+#include "dataset.hpp"
+#include "params.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// k-means on sparse rows of any dimension (`DatasetHeader::sparse`), such as
+// TF-IDF vectors. `Mode::kLloyd` minimizes squared Euclidean distances,
+// taken as `|x|^2 - 2 x.c + |c|^2` from sparse-dense dot products.
+// `Mode::kSpherical` (Dhillon and Modha, 2001) maximizes cosine similarity:
+// rows are normalized once, centroids are normalized sums of their rows, and
+// the reported inertia is the sum of `1 - cos(x, c)`.
+//
+// Centroids are dense and kept transposed as well, so every nonzero of a row
+// updates its dot products with all centroids in one contiguous loop.
+// Centroids are updated from rows grouped by cluster, summed in file order
+// into a dense scratch row per thread. Seeding is `Seeding::kRandom` only.
+class SparseSolver {
+ public:
+  explicit SparseSolver(Params params);
+
+  auto Solve(const std::string& input, const std::string& output) -> void;
+
+  auto LastReport() const -> const Report&;
+
+ private:
+  auto Normalize(SparseDataset& data) const -> void;
+
+  auto ChooseCentroids(const SparseDataset& data) -> void;
+
+  // Assigns rows and moves centroids, returns whether any centroid moved.
+  // Fills changes and inertia of `stats`.
+  auto Step(const SparseDataset& data, StepStats& stats) -> bool;
+
+  // Refreshes `transposed_` and `norms_` from `centroids_`.
+  auto Load() -> void;
+
+  // Nearest centroid of row `p` by the objective of the mode, `scores`
+  // being scratch space of `k_` dot products.
+  auto Nearest(const SparseDataset& data, config::Index p,
+               std::vector<double>& scores) const -> config::Index;
+
+  // Squared distance, or `1 - cos`, of row `p` to centroid `c`.
+  auto Loss(const SparseDataset& data, config::Index p, config::Index c) const
+      -> double;
+
+  auto ComputeInertia(const SparseDataset& data) -> double;
+
+ private:
+  Params params_;
+  Report report_;
+
+  config::Size k_{0};
+  config::Size dim_{0};
+  std::vector<double> centroids_;   // row-major, `k_` rows
+  std::vector<double> transposed_;  // `dim_` rows of `k_` coordinates
+  std::vector<double> norms_;       // squared norms of centroids
+  std::vector<config::Index> labels_;
+};
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+
+#include "streaming.hpp"
+#include "io.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+ChunkReader::ChunkReader(const std::string& input)
+    : in_(input, std::ios::binary) {
+  if (!in_) {
+    throw std::runtime_error("Cannot open " + input);
+  }
+
+  auto header = BinaryHeader{};
+  // NOLINTNEXTLINE
+  in_.read(reinterpret_cast<char*>(&header), sizeof(header));
+  binary_ = in_ && header.magic == BinaryHeader::kMagic;
+
+  if (binary_) {
+    if (header.dimension != 2) {
+      throw std::invalid_argument("Streaming mode supports 2D points only");
+    }
+    point_count_ = header.point_count;
+    cluster_count_ = header.cluster_count;
+  } else {
+    in_.clear();
+    in_.seekg(0);
+    in_ >> point_count_ >> cluster_count_;
+  }
+
+  if (!in_ || point_count_ == 0 || cluster_count_ == 0) {
+    throw std::runtime_error("Bad header in " + input);
+  }
+
+  left_ = point_count_;
+}
+
+auto ChunkReader::PointCount() const -> config::Size {
+  return point_count_;
+}
+
+auto ChunkReader::ClusterCount() const -> config::Size {
+  return cluster_count_;
+}
+
+auto ChunkReader::Read(Points& chunk, config::Size size) -> bool {
+  chunk.resize(std::min(size, left_));
+
+  if (binary_) {
+    coords_.resize(2 * chunk.size());
+    // NOLINTNEXTLINE
+    in_.read(reinterpret_cast<char*>(coords_.data()),
+             static_cast<std::streamsize>(coords_.size() * sizeof(double)));
+    for (auto p = config::Index{0}; p < chunk.size(); ++p) {
+      chunk[p].x = coords_[2 * p];
+      chunk[p].y = coords_[2 * p + 1];
+    }
+  } else {
+    for (auto& p : chunk) {
+      in_ >> p;
+    }
+  }
+
+  if (!in_) {
+    throw std::runtime_error("Truncated dataset");
+  }
+
+  left_ -= chunk.size();
+  return !chunk.empty();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+StreamingSolver::StreamingSolver(Params params) : params_(params) {
+}
+
+auto StreamingSolver::Solve(const std::string& input, const std::string& output)
+    -> void {
+  report_ = {};
+
+  auto start = config::Clock::now();
+  Seed(input);
+  report_.seeding =
+      std::chrono::duration_cast<config::Mcs>(config::Clock::now() - start);
+
+  for (auto epoch = config::Size{0}; epoch < params_.epochs; ++epoch) {
+    Scan(input, [this](Points& chunk) {
+      Train(chunk);
+    });
+  }
+
+  auto out = std::ofstream{output};
+  for (const auto& c : clusters_) {
+    out << c.Centroid() << '\n';
+  }
+
+  centroids_.Load(clusters_);
+  report_.inertia = 0;
+  Scan(input, [this, &out](Points& chunk) {
+    Assign(chunk);
+    for (const auto& p : chunk) {
+      out << p.cluster_index << '\n';
+    }
+  });
+}
+
+auto StreamingSolver::LastReport() const -> const Report& {
+  return report_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename Process>
+auto StreamingSolver::Scan(const std::string& input, Process process) -> void {
+  auto reader = ChunkReader{input};
+  auto size = params_.chunk_size;
+
+  auto current = Points{};
+  auto next = Points{};
+  auto more = reader.Read(current, size);
+
+  while (more) {
+    auto reading = std::async(std::launch::async, [&] {
+      return reader.Read(next, size);
+    });
+
+    process(current);
+
+    more = reading.get();
+    std::swap(current, next);
+  }
+}
+
+// Seeds from the first chunk, which holds at least `k` points.
+auto StreamingSolver::Seed(const std::string& input) -> void {
+  auto reader = ChunkReader{input};
+  auto k = reader.ClusterCount();
+
+  auto first = Points{};
+  reader.Read(first, std::max(params_.chunk_size, k));
+
+  clusters_.assign(k, Cluster{});
+  seen_.assign(k, 0);
+  ChooseCentroids(params_.seeding, first, clusters_, params_.seed);
+}
+
+auto StreamingSolver::Train(Points& chunk) -> void {
+  const auto k = clusters_.size();
+
+  centroids_.Load(clusters_);
+  Assign(chunk);
+
+  auto sums = std::vector<double>(2 * k, 0);
+  auto counts = std::vector<double>(k, 0);
+
+  for (const auto& p : chunk) {
+    sums[2 * p.cluster_index] += p.x;
+    sums[2 * p.cluster_index + 1] += p.y;
+    counts[p.cluster_index] += 1;
+  }
+
+  // Applying `c += (x - c) / seen` point by point telescopes into
+  // one step per chunk: the centroid stays the mean of all absorbed points.
+  for (auto c = config::Index{0}; c < k; ++c) {
+    if (counts[c] == 0) {
+      continue;
+    }
+
+    seen_[c] += counts[c];
+    auto& centroid = clusters_[c].Centroid();
+    centroid.x += (sums[2 * c] - counts[c] * centroid.x) / seen_[c];
+    centroid.y += (sums[2 * c + 1] - counts[c] * centroid.y) / seen_[c];
+  }
+
+  report_.history.push_back({chunk.size() * k, 0});
+}
+
+auto StreamingSolver::Assign(Points& chunk) -> void {
+  auto block_count =
+      (chunk.size() + config::kBlockSize - 1) / config::kBlockSize;
+  auto inertia = 0.0;
+
+  // NOLINTNEXTLINE
+#pragma omp parallel for num_threads(config::ThreadCount()) schedule(runtime) reduction(+:inertia)
+  for (auto b = config::Index{0}; b < block_count; ++b) {
+    auto first = b * config::kBlockSize;
+    auto last = std::min(chunk.size(), first + config::kBlockSize);
+
+    kernels::AssignNearest(centroids_, &chunk[first], last - first);
+
+    for (auto p = first; p < last; ++p) {
+      auto dx = chunk[p].x - centroids_.x[chunk[p].cluster_index];
+      auto dy = chunk[p].y - centroids_.y[chunk[p].cluster_index];
+      inertia += dx * dx + dy * dy;
+    }
+  }
+
+  report_.inertia += inertia;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+#include "cluster.hpp"
+#include "kernels.hpp"
+#include "params.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Reads points of a text or binary 2D dataset file a chunk at a time.
+class ChunkReader {
+ public:
+  explicit ChunkReader(const std::string& input);
+
+  auto PointCount() const -> config::Size;
+  auto ClusterCount() const -> config::Size;
+
+  // Fills `chunk` with up to `size` next points, returns false at the end.
+  auto Read(Points& chunk, config::Size size) -> bool;
+
+ private:
+  std::ifstream in_;
+  bool binary_{false};
+  std::vector<double> coords_;  // of the last binary chunk
+  config::Size point_count_{0};
+  config::Size cluster_count_{0};
+  config::Size left_{0};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Mini-batch k-means (Sculley, 2010) for datasets that do not fit in memory.
+// The file is streamed `epochs` times to train centroids on consecutive
+// chunks with per-centroid learning rates `1 / points seen`, and once more to
+// assign and write labels. Only two chunks are kept in memory at a time:
+// the next one is read in the background while the current one is assigned.
+class StreamingSolver {
+ public:
+  explicit StreamingSolver(Params params);
+
+  auto Solve(const std::string& input, const std::string& output) -> void;
+
+  auto LastReport() const -> const Report&;
+
+ private:
+  // Calls `process` on every chunk, reading the next one meanwhile.
+  template <typename Process>
+  auto Scan(const std::string& input, Process process) -> void;
+
+  auto Seed(const std::string& input) -> void;
+  auto Train(Points& chunk) -> void;
+  auto Assign(Points& chunk) -> void;
+
+ private:
+  Params params_;
+  Report report_;
+
+  Clusters clusters_;
+  Centroids centroids_;
+  std::vector<double> seen_;  // points absorbed per centroid
+};
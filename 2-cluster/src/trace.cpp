@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "trace.hpp"
+#include "parallel.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// Microseconds since the origin of the trace.
+using Us = std::chrono::duration<double, std::micro>;
+
+// Own cache line each, threads update theirs concurrently.
+struct alignas(64) Work {
+  double first_us{0};
+  double last_us{0};
+  double busy_us{0};
+  config::Size items{0};
+};
+
+struct Region {
+  config::Index run{0};
+  config::Index iteration{0};
+  std::string_view name;
+  double start_us{0};
+  double end_us{0};
+  std::vector<Work> threads;  // by `parallel::WorkerIndex()`
+};
+
+struct Iteration {
+  config::Index run{0};
+  config::Index iteration{0};
+  double end_us{0};
+  StepStats stats;
+};
+
+struct State {
+  config::Clock::time_point origin{config::Clock::now()};
+  std::vector<std::string> runs;
+  std::vector<Region> regions;
+  std::vector<Iteration> iterations;
+  config::Index iteration{0};
+  bool active{false};  // the last region is open
+};
+
+auto Global() -> State& {
+  static auto state = State{};
+  return state;
+}
+
+auto Elapsed(config::Clock::time_point time) -> double {
+  return Us{time - Global().origin}.count();
+}
+
+auto Quote(std::string_view text) -> std::string {
+  auto quoted = std::string{'"'};
+  for (auto c : text) {
+    if (c == '"' || c == '\\') {
+      quoted += '\\';
+    }
+    quoted += c;
+  }
+  return quoted + '"';
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace trace {
+
+auto BeginRun(std::string name) -> void {
+  auto& state = Global();
+  state.runs.push_back(std::move(name));
+  state.iteration = 0;
+  state.active = false;
+}
+
+auto BeginRegion(std::string_view name) -> void {
+  auto& state = Global();
+  if (state.runs.empty()) {
+    state.runs.emplace_back("run");
+  }
+
+  auto region = Region{};
+  region.run = state.runs.size() - 1;
+  region.iteration = state.iteration;
+  region.name = name;
+  region.threads.resize(static_cast<config::Size>(config::ThreadCount()));
+  region.start_us = Elapsed(config::Clock::now());
+
+  state.regions.push_back(std::move(region));
+  state.active = true;
+}
+
+auto EndRegion() -> void {
+  auto& state = Global();
+  if (state.active) {
+    state.regions.back().end_us = Elapsed(config::Clock::now());
+    state.active = false;
+  }
+}
+
+auto AddWork(config::Clock::time_point start) -> void {
+  auto& state = Global();
+  auto end = config::Clock::now();
+  auto thread = parallel::WorkerIndex();
+  if (!state.active || thread >= state.regions.back().threads.size()) {
+    return;
+  }
+
+  auto& work = state.regions.back().threads[thread];
+  auto first = Elapsed(start);
+  if (work.items == 0) {
+    work.first_us = first;
+  }
+  work.last_us = Elapsed(end);
+  work.busy_us += work.last_us - first;
+  ++work.items;
+}
+
+auto EndIteration(const StepStats& stats) -> void {
+  auto& state = Global();
+  if (state.runs.empty()) {
+    return;
+  }
+
+  state.iterations.push_back({state.runs.size() - 1, state.iteration,
+                              Elapsed(config::Clock::now()), stats});
+  ++state.iteration;
+}
+
+auto Clear() -> void {
+  Global() = State{};
+}
+
+auto WriteChrome(std::ostream& out) -> void {
+  const auto& state = Global();
+  out << std::fixed << std::setprecision(3) << "{\"traceEvents\": [\n";
+
+  auto separator = "  ";
+  auto event = [&out, &separator] {
+    out << separator;
+    separator = ",\n  ";
+  };
+
+  for (auto run = config::Index{0}; run < state.runs.size(); ++run) {
+    event();
+    out << "{\"ph\": \"M\", \"name\": \"process_name\", \"pid\": " << run
+        << ", \"args\": {\"name\": " << Quote(state.runs[run]) << "}}";
+  }
+
+  auto named = std::map<std::pair<config::Index, config::Index>, bool>{};
+  for (const auto& region : state.regions) {
+    event();
+    out << "{\"ph\": \"X\", \"cat\": \"region\", \"name\": "
+        << Quote(region.name) << ", \"pid\": " << region.run
+        << ", \"tid\": 0, \"ts\": " << region.start_us
+        << ", \"dur\": " << region.end_us - region.start_us
+        << ", \"args\": {\"iteration\": " << region.iteration << "}}";
+
+    // Thread `t` is track `t + 1`, the solver is track 0.
+    for (auto t = config::Index{0}; t < region.threads.size(); ++t) {
+      const auto& work = region.threads[t];
+      if (work.items == 0) {
+        continue;
+      }
+      if (!std::exchange(named[{region.run, t}], true)) {
+        event();
+        out << "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": "
+            << region.run << ", \"tid\": " << t + 1
+            << ", \"args\": {\"name\": \"thread " << t << "\"}}";
+      }
+
+      event();
+      out << "{\"ph\": \"X\", \"cat\": \"work\", \"name\": "
+          << Quote(region.name) << ", \"pid\": " << region.run
+          << ", \"tid\": " << t + 1 << ", \"ts\": " << work.first_us
+          << ", \"dur\": " << work.last_us - work.first_us
+          << ", \"args\": {\"iteration\": " << region.iteration
+          << ", \"busy_us\": " << work.busy_us
+          << ", \"items\": " << work.items << "}}";
+    }
+  }
+
+  for (const auto& iteration : state.iterations) {
+    const auto& stats = iteration.stats;
+    event();
+    out << "{\"ph\": \"C\", \"name\": \"distances\", \"pid\": "
+        << iteration.run << ", \"ts\": " << iteration.end_us
+        << ", \"args\": {\"computed\": " << stats.computed
+        << ", \"skipped\": " << stats.skipped << "}}";
+    event();
+    out << "{\"ph\": \"C\", \"name\": \"changed\", \"pid\": "
+        << iteration.run << ", \"ts\": " << iteration.end_us
+        << ", \"args\": {\"changed\": " << stats.changed << "}}";
+    event();
+    out << "{\"ph\": \"C\", \"name\": \"inertia\", \"pid\": "
+        << iteration.run << ", \"ts\": " << iteration.end_us
+        << ", \"args\": {\"inertia\": " << stats.inertia << "}}";
+  }
+
+  out << "\n]}\n" << std::defaultfloat;
+}
+
+auto WriteCsv(std::ostream& out) -> void {
+  const auto& state = Global();
+
+  auto stats = std::map<std::pair<config::Index, config::Index>, StepStats>{};
+  for (const auto& iteration : state.iterations) {
+    stats[{iteration.run, iteration.iteration}] = iteration.stats;
+  }
+
+  out << "run,input,iteration,region,wall_us,busy_mean_us,busy_max_us,"
+         "imbalance,computed,skipped,changed,inertia\n";
+
+  for (const auto& region : state.regions) {
+    auto busy_max = 0.0;
+    auto busy_sum = 0.0;
+    for (const auto& work : region.threads) {
+      busy_max = std::max(busy_max, work.busy_us);
+      busy_sum += work.busy_us;
+    }
+    auto busy_mean =
+        busy_sum / static_cast<double>(std::max<config::Size>(
+                       1, region.threads.size()));
+
+    out << std::fixed << std::setprecision(1) << region.run << ','
+        << state.runs[region.run] << ',' << region.iteration + 1 << ','
+        << region.name << ',' << region.end_us - region.start_us << ','
+        << busy_mean << ',' << busy_max << ',' << std::setprecision(3);
+    if (busy_mean > 0) {
+      out << busy_max / busy_mean;
+    }
+
+    // Iterations cut short by an exception have no stats.
+    out << std::defaultfloat << std::setprecision(10);
+    if (auto it = stats.find({region.run, region.iteration});
+        it != stats.end()) {
+      out << ',' << it->second.computed << ',' << it->second.skipped << ','
+          << it->second.changed << ',' << it->second.inertia;
+    } else {
+      out << ",,,,";
+    }
+    out << '\n';
+  }
+}
+
+}  // namespace trace
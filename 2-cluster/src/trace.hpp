@@ -0,0 +1,80 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "config.hpp"
+#include "engine.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Per-iteration instrumentation, compiled in by `-DCLUSTER_TRACE=ON` only.
+// Otherwise the macros below expand to nothing and cost nothing.
+//
+// A run is one `Solver::Solve`. Within it, every phase of an iteration is
+// a region (`TRACE_BEGIN` / `TRACE_END`, never nested) timed as a whole,
+// and `TRACE_WORK` scopes inside its parallel loops add up how long every
+// thread was busy, which shows load imbalance (not recorded for threads
+// of `Backend::kStd`, see `parallel::WorkerIndex`). `TRACE_ITERATION`
+// closes an iteration with its `StepStats`.
+#ifdef CLUSTER_TRACE
+#define TRACE_RUN(name) trace::BeginRun(name)
+#define TRACE_BEGIN(name) trace::BeginRegion(name)
+#define TRACE_END() trace::EndRegion()
+#define TRACE_WORK() const auto trace_work = trace::WorkScope{}
+#define TRACE_ITERATION(stats) trace::EndIteration(stats)
+#else
+#define TRACE_RUN(name) static_cast<void>(0)
+#define TRACE_BEGIN(name) static_cast<void>(0)
+#define TRACE_END() static_cast<void>(0)
+#define TRACE_WORK() static_cast<void>(0)
+#define TRACE_ITERATION(stats) static_cast<void>(0)
+#endif
+
+namespace trace {
+
+#ifdef CLUSTER_TRACE
+constexpr auto kEnabled = true;
+#else
+constexpr auto kEnabled = false;
+#endif
+
+auto BeginRun(std::string name) -> void;
+
+// `name` must outlive the trace, string literals only.
+auto BeginRegion(std::string_view name) -> void;
+auto EndRegion() -> void;
+
+// Called by any thread of the current region.
+auto AddWork(config::Clock::time_point start) -> void;
+
+auto EndIteration(const StepStats& stats) -> void;
+
+// Drops everything recorded so far.
+auto Clear() -> void;
+
+// Chrome trace (`chrome://tracing`, Perfetto): a process per run, a thread
+// for regions and one per OpenMP thread spanning its work in every region,
+// and a counter track of `StepStats`.
+auto WriteChrome(std::ostream& out) -> void;
+
+// A row per region: wall time, mean and maximum busy time over the
+// threads of the region, their ratio (1 is perfect balance) and the
+// `StepStats` of its iteration.
+auto WriteCsv(std::ostream& out) -> void;
+
+class WorkScope {
+ public:
+  WorkScope() = default;
+  WorkScope(const WorkScope&) = delete;
+  auto operator=(const WorkScope&) -> WorkScope& = delete;
+  ~WorkScope() {
+    AddWork(start_);
+  }
+
+ private:
+  config::Clock::time_point start_{config::Clock::now()};
+};
+
+}  // namespace trace
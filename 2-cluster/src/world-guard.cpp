@@ -0,0 +1,22 @@
+#include <mpi.h>
+
+#include "macros.hpp"
+#include "world-guard.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+WorldGuard::WorldGuard(int c, char** v) : argc(c), argv(v) {
+  auto provided = 0;
+  EXPECT_OK(MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided));
+  if (provided < MPI_THREAD_FUNNELED) {
+    MPI_Finalize();
+    throw std::runtime_error("MPI does not support MPI_THREAD_FUNNELED");
+  }
+
+  EXPECT_OK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+  EXPECT_OK(MPI_Comm_size(MPI_COMM_WORLD, &size));
+}
+
+WorldGuard::~WorldGuard() {
+  MPI_Finalize();
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Initializes MPI for the lifetime of the guard. Only the main thread makes
+// MPI calls, OpenMP threads never do.
+struct WorldGuard {
+  WorldGuard(int c, char** v);
+  ~WorldGuard();
+
+  WorldGuard(const WorldGuard&) = delete;
+  auto operator=(const WorldGuard&) -> WorldGuard& = delete;
+
+  int argc;
+  char** argv;
+  int rank{0};
+  int size{1};
+};
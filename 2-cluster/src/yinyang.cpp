@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "yinyang.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr auto kInf = std::numeric_limits<double>::infinity();
+
+constexpr auto kCentroidsPerGroup = config::Size{10};
+constexpr auto kGroupingIterations = 5;
+
+// Per-thread buffers reused across points.
+struct Scratch {
+  std::vector<double> values;
+  std::vector<double> first;
+  std::vector<double> second;
+  std::vector<config::Index> first_index;
+  std::vector<bool> examined;
+
+  auto Resize(config::Size k, config::Size groups) -> Scratch& {
+    values.resize(std::max(k, groups));
+    first.resize(groups);
+    second.resize(groups);
+    first_index.resize(groups);
+    examined.resize(groups);
+    return *this;
+  }
+};
+
+auto LocalScratch(config::Size k, config::Size groups) -> Scratch& {
+  thread_local auto scratch = Scratch{};
+  return scratch.Resize(k, groups);
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+YinyangEngine::YinyangEngine(Points& points, Clusters& clusters)
+    : BoundedEngine(points, clusters), upper_(points.size(), kInf) {
+  MakeGroups();
+  lower_.assign(points.size() * groups_.size(), 0);
+}
+
+// Groups initial centroids by a few Lloyd iterations over centroids
+// themselves, seeded with the first `k / 10` of them.
+auto YinyangEngine::MakeGroups() -> void {
+  const auto k = clusters_.size();
+  const auto t = std::max(config::Size{1}, k / kCentroidsPerGroup);
+
+  auto seeds = Points(t);
+  for (auto g = config::Index{0}; g < t; ++g) {
+    seeds[g].x = clusters_[g].Centroid().x;
+    seeds[g].y = clusters_[g].Centroid().y;
+  }
+
+  group_of_.assign(k, 0);
+
+  for (auto it = 0; it < kGroupingIterations; ++it) {
+    auto sums = std::vector<double>(2 * t, 0);
+    auto sizes = std::vector<config::Size>(t, 0);
+
+    for (auto c = config::Index{0}; c < k; ++c) {
+      const auto& centroid = clusters_[c].Centroid();
+      auto min_dist = kInf;
+      for (auto g = config::Index{0}; g < t; ++g) {
+        auto dx = centroid.x - seeds[g].x;
+        auto dy = centroid.y - seeds[g].y;
+        if (auto dist = dx * dx + dy * dy; dist < min_dist) {
+          min_dist = dist;
+          group_of_[c] = g;
+        }
+      }
+
+      sums[2 * group_of_[c]] += centroid.x;
+      sums[2 * group_of_[c] + 1] += centroid.y;
+      sizes[group_of_[c]] += 1;
+    }
+
+    for (auto g = config::Index{0}; g < t; ++g) {
+      if (sizes[g] != 0) {
+        seeds[g].x = sums[2 * g] / static_cast<double>(sizes[g]);
+        seeds[g].y = sums[2 * g + 1] / static_cast<double>(sizes[g]);
+      }
+    }
+  }
+
+  // Drop groups left empty and renumber the rest.
+  auto renumber = std::vector<config::Index>(t, t);
+  groups_.clear();
+
+  for (auto c = config::Index{0}; c < k; ++c) {
+    auto& g = renumber[group_of_[c]];
+    if (g == t) {
+      g = groups_.size();
+      groups_.emplace_back();
+    }
+    groups_[g].push_back(c);
+    group_of_[c] = g;
+  }
+
+  group_drift_.assign(groups_.size(), 0);
+}
+
+auto YinyangEngine::Prepare() -> void {
+  for (auto g = config::Index{0}; g < groups_.size(); ++g) {
+    group_drift_[g] = 0;
+    for (auto c : groups_[g]) {
+      group_drift_[g] = std::max(group_drift_[g], drift_[c]);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+auto YinyangEngine::AssignAll(config::Index p) -> config::Size {
+  const auto k = clusters_.size();
+  const auto t = groups_.size();
+  auto* lower = &lower_[p * t];
+  auto& point = points_[p];
+  auto& dists = LocalScratch(k, t).values;
+
+  auto nearest = config::Index{0};
+  auto min_dist = kInf;
+
+  for (auto c = config::Index{0}; c < k; ++c) {
+    dists[c] = Distance2To(c, point);
+    if (dists[c] < min_dist) {
+      nearest = c;
+      min_dist = dists[c];
+    }
+  }
+
+  for (auto g = config::Index{0}; g < t; ++g) {
+    auto group_min = kInf;
+    for (auto c : groups_[g]) {
+      if (c != nearest) {
+        group_min = std::min(group_min, dists[c]);
+      }
+    }
+    lower[g] = std::sqrt(group_min);
+  }
+
+  point.cluster_index = nearest;
+  upper_[p] = std::sqrt(min_dist);
+
+  return k;
+}
+
+auto YinyangEngine::AssignPruned(config::Index p) -> config::Size {
+  const auto k = clusters_.size();
+  const auto t = groups_.size();
+  auto* lower = &lower_[p * t];
+  auto& point = points_[p];
+  auto& scratch = LocalScratch(k, t);
+  auto& previous = scratch.values;
+
+  auto nearest = point.cluster_index;
+  upper_[p] += drift_[nearest];
+
+  auto global = kInf;
+  for (auto g = config::Index{0}; g < t; ++g) {
+    previous[g] = lower[g];
+    lower[g] -= group_drift_[g];
+    global = std::min(global, lower[g]);
+  }
+
+  if (Inflate(upper_[p]) < global) {
+    return 0;
+  }
+
+  auto min_dist = Distance2To(nearest, point);
+  auto bound = std::sqrt(min_dist);
+  auto upper = Inflate(bound);
+  auto computed = config::Size{1};
+
+  if (upper < global) {
+    upper_[p] = bound;
+    return computed;
+  }
+
+  const auto old_nearest = nearest;
+  const auto old_bound = bound;
+
+  for (auto g = config::Index{0}; g < t; ++g) {
+    scratch.examined[g] = false;
+    if (upper < lower[g]) {
+      continue;
+    }
+
+    // Smallest and second smallest lower bound (or exact distance) within
+    // the group, so the bound can exclude whichever centroid wins in the end.
+    auto first = kInf;
+    auto second = kInf;
+    auto first_index = k;
+
+    for (auto c : groups_[g]) {
+      auto value = old_bound;
+
+      if (c != old_nearest) {
+        value = previous[g] - drift_[c];
+
+        if (!(upper < value)) {
+          auto dist = Distance2To(c, point);
+          value = std::sqrt(dist);
+          ++computed;
+
+          if (dist < min_dist || (dist == min_dist && c < nearest)) {
+            nearest = c;
+            min_dist = dist;
+            bound = value;
+            upper = Inflate(bound);
+          }
+        }
+      }
+
+      if (value < first) {
+        second = first;
+        first = value;
+        first_index = c;
+      } else if (value < second) {
+        second = value;
+      }
+    }
+
+    scratch.examined[g] = true;
+    scratch.first[g] = first;
+    scratch.second[g] = second;
+    scratch.first_index[g] = first_index;
+  }
+
+  for (auto g = config::Index{0}; g < t; ++g) {
+    if (scratch.examined[g]) {
+      lower[g] = scratch.first_index[g] == nearest ? scratch.second[g]
+                                                   : scratch.first[g];
+    }
+  }
+
+  // The previous centroid is no longer excluded from its group's bound.
+  if (auto g = group_of_[old_nearest];
+      nearest != old_nearest && !scratch.examined[g]) {
+    lower[g] = std::min(lower[g], old_bound);
+  }
+
+  point.cluster_index = nearest;
+  upper_[p] = bound;
+
+  return computed;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+
+#include "bounded.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Yinyang k-means (Ding et al., 2015): centroids are clustered into
+// `k / 10` groups once, every point keeps one upper bound and one lower bound
+// per group. Groups whose bound exceeds the upper bound are skipped as a whole,
+// inside the remaining ones centroids are filtered by their own drift.
+// O(n * k / 10) memory.
+class YinyangEngine : public BoundedEngine {
+ public:
+  YinyangEngine(Points& points, Clusters& clusters);
+
+ protected:
+  auto Prepare() -> void override;
+
+  auto AssignAll(config::Index p) -> config::Size override;
+  auto AssignPruned(config::Index p) -> config::Size override;
+
+ private:
+  auto MakeGroups() -> void;
+
+ private:
+  std::vector<std::vector<config::Index>> groups_;
+  std::vector<config::Index> group_of_;
+  std::vector<double> group_drift_;
+
+  std::vector<double> upper_;
+  std::vector<double> lower_;  // n rows of one bound per group
+};